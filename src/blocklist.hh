@@ -0,0 +1,374 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Stefan Fischerländer
+ *
+ * This file is part of Tablecruncher.
+ *
+ * Tablecruncher is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * Tablecruncher is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tablecruncher. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _BLOCKLIST_HH
+#define _BLOCKLIST_HH
+
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+
+
+/**
+	\brief A sequence of elements stored in blocks of at most `BLOCK_SIZE` elements.
+
+	Inserting or erasing an element only moves the elements of its own block. The number of elements per block
+	is kept in a Fenwick tree, so finding the block of a position and updating the counts is O(log blocks).
+	Blocks that grow too large are split in halves, empty blocks are dropped; both rebuild the Fenwick tree,
+	which happens at most once per `BLOCK_SIZE / 2` single-element inserts.
+
+	Appending with `push_back()` fills every block completely, so scanning a loaded table stays cache-friendly.
+
+	Blocks are shared between copies of a list and only cloned when one of the copies writes to them (copy on
+	write), so copying a list costs a pointer per block and the copies only grow by the blocks changed since.
+	That's why elements can only be read by reference, changes go through `set()` and the other modifiers.
+	Blocks aren't cloned thread-safe: don't modify a list concurrently.
+ */
+template <typename T>
+class BlockList {
+
+public:
+	static constexpr size_t BLOCK_SIZE = 4096;
+
+	/**
+		Forward iterator over all elements, block by block
+	 */
+	template <typename List, typename Value>
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Value *;
+		using reference = Value &;
+
+		Iterator(List *list, size_t block, size_t offset) : list(list), block(block), offset(offset) {}
+		reference operator*() const { return (*list->blocks[block])[offset]; }
+		pointer operator->() const { return &(*list->blocks[block])[offset]; }
+		Iterator &operator++() {
+			if( ++offset == list->blocks[block]->size() ) {
+				++block;
+				offset = 0;
+			}
+			return *this;
+		}
+		bool operator==(const Iterator &other) const { return block == other.block && offset == other.offset; }
+		bool operator!=(const Iterator &other) const { return !(*this == other); }
+
+	private:
+		List *list;
+		size_t block;
+		size_t offset;
+	};
+
+	typedef Iterator<const BlockList, const T> const_iterator;
+
+	size_t size() const {
+		return numElements;
+	}
+
+	bool empty() const {
+		return numElements == 0;
+	}
+
+	void clear() {
+		blocks.clear();
+		blocks.shrink_to_fit();
+		tree.clear();
+		tree.shrink_to_fit();
+		numElements = 0;
+	}
+
+	const T &operator[](size_t pos) const {
+		std::pair<size_t, size_t> loc = locate(pos);
+		return (*blocks[loc.first])[loc.second];
+	}
+
+	const T &at(size_t pos) const {
+		checkRange(pos);
+		return (*this)[pos];
+	}
+
+	/**
+		Replaces the element at position `pos` by `value`
+	 */
+	void set(size_t pos, const T &value) {
+		checkRange(pos);
+		std::pair<size_t, size_t> loc = locate(pos);
+		mutableBlock(loc.first)[loc.second] = value;
+	}
+
+	const_iterator begin() const { return const_iterator(this, 0, 0); }
+	const_iterator end() const { return const_iterator(this, blocks.size(), 0); }
+
+	/**
+		Appends `value`, a new block is started only if the last one is full
+	 */
+	void push_back(const T &value) {
+		if( blocks.empty() || blocks.back()->size() >= BLOCK_SIZE ) {
+			blocks.push_back( newBlock() );
+			appendTreeNode();
+		}
+		mutableBlock(blocks.size() - 1).push_back(value);
+		add(blocks.size() - 1, 1);
+		++numElements;
+	}
+
+	/**
+		Inserts `value` before position `pos` (pos == size() appends)
+	 */
+	void insert(size_t pos, const T &value) {
+		if( pos >= numElements ) {
+			push_back(value);
+			return;
+		}
+		std::pair<size_t, size_t> loc = locate(pos);
+		std::vector<T> &block = mutableBlock(loc.first);
+		block.insert(block.begin() + loc.second, value);
+		++numElements;
+		if( block.size() > BLOCK_SIZE ) {
+			std::shared_ptr< std::vector<T> > upperHalf = std::make_shared< std::vector<T> >(block.begin() + block.size() / 2, block.end());
+			block.resize(block.size() / 2);
+			blocks.insert(blocks.begin() + loc.first + 1, std::move(upperHalf));
+			rebuildTree();
+		} else {
+			add(loc.first, 1);
+		}
+	}
+
+	/**
+		Inserts all `values` before position `pos` (pos == size() appends). The block at `pos` is split and
+		the values go into full blocks in between, so this is O(blocks + values.size()).
+	 */
+	void insert(size_t pos, const std::vector<T> &values) {
+		if( pos >= numElements ) {
+			for( const T &value : values ) {
+				push_back(value);
+			}
+			return;
+		}
+		if( values.empty() ) {
+			return;
+		}
+		std::pair<size_t, size_t> loc = locate(pos);
+		size_t b = loc.first;
+		if( loc.second > 0 ) {
+			const std::vector<T> &block = *blocks[b];
+			std::shared_ptr< std::vector<T> > upperPart = std::make_shared< std::vector<T> >(block.begin() + loc.second, block.end());
+			mutableBlock(b).resize(loc.second);
+			blocks.insert(blocks.begin() + b + 1, std::move(upperPart));
+			++b;
+		}
+		std::vector< std::shared_ptr< std::vector<T> > > newBlocks;
+		for( size_t i = 0; i < values.size(); i += BLOCK_SIZE ) {
+			newBlocks.push_back( std::make_shared< std::vector<T> >(values.begin() + i, values.begin() + std::min(i + BLOCK_SIZE, values.size())) );
+		}
+		blocks.insert(blocks.begin() + b, newBlocks.begin(), newBlocks.end());
+		numElements += values.size();
+		rebuildTree();
+	}
+
+	/**
+		Erases the elements at positions [from, to)
+	 */
+	void erase(size_t from, size_t to) {
+		if( to > numElements ) {
+			to = numElements;
+		}
+		if( from >= to ) {
+			return;
+		}
+		size_t remaining = to - from;
+		std::pair<size_t, size_t> loc = locate(from);
+		size_t b = loc.first;
+		size_t offset = loc.second;
+		bool blocksDropped = false;
+		while( remaining > 0 ) {
+			size_t n = std::min(remaining, blocks[b]->size() - offset);
+			remaining -= n;
+			numElements -= n;
+			if( n == blocks[b]->size() ) {
+				blocks.erase(blocks.begin() + b);		// whole blocks are dropped without cloning them
+				blocksDropped = true;
+			} else {
+				std::vector<T> &block = mutableBlock(b);
+				block.erase(block.begin() + offset, block.begin() + offset + n);
+				if( !blocksDropped ) {
+					add(b, -(std::ptrdiff_t) n);
+				}
+				++b;
+			}
+			offset = 0;
+		}
+		if( blocksDropped ) {
+			rebuildTree();
+		}
+	}
+
+	/**
+		Erases all elements for which `predicate(position, element)` is true in a single pass; the order of
+		the remaining elements is kept and they get packed into full blocks
+	 */
+	template <typename Predicate>
+	void eraseIf(Predicate predicate) {
+		std::vector< std::shared_ptr< std::vector<T> > > kept;
+		size_t pos = 0;
+		size_t numKept = 0;
+		for( std::shared_ptr< std::vector<T> > &block : blocks ) {
+			bool shared = block.use_count() > 1;			// shared blocks are left untouched for the other copies
+			for( T &element : *block ) {
+				if( !predicate(pos++, element) ) {
+					if( kept.empty() || kept.back()->size() >= BLOCK_SIZE ) {
+						kept.push_back( newBlock() );
+					}
+					if( shared ) {
+						kept.back()->push_back(element);
+					} else {
+						kept.back()->push_back(std::move(element));
+					}
+					++numKept;
+				}
+			}
+			block.reset();
+		}
+		blocks.swap(kept);
+		numElements = numKept;
+		rebuildTree();
+	}
+
+	/**
+		Copies all elements into a single vector
+	 */
+	std::vector<T> toVector() const {
+		std::vector<T> all;
+		all.reserve(numElements);
+		for( const std::shared_ptr< std::vector<T> > &block : blocks ) {
+			all.insert(all.end(), block->begin(), block->end());
+		}
+		return all;
+	}
+
+	/**
+		Replaces the content by `values`, stored in full blocks
+	 */
+	void assign(const std::vector<T> &values) {
+		blocks.clear();
+		for( size_t i = 0; i < values.size(); i += BLOCK_SIZE ) {
+			blocks.push_back( std::make_shared< std::vector<T> >(values.begin() + i, values.begin() + std::min(i + BLOCK_SIZE, values.size())) );
+		}
+		numElements = values.size();
+		rebuildTree();
+	}
+
+
+private:
+	std::vector< std::shared_ptr< std::vector<T> > > blocks;	// the elements in order, blocks may be shared with copies of the list
+	std::vector<size_t> tree;							// Fenwick tree (1-based) of the block sizes
+	size_t numElements = 0;
+
+	void checkRange(size_t pos) const {
+		if( pos >= numElements ) {
+			throw std::out_of_range("BlockList: position out of range");
+		}
+	}
+
+	static std::shared_ptr< std::vector<T> > newBlock() {
+		std::shared_ptr< std::vector<T> > block = std::make_shared< std::vector<T> >();
+		block->reserve(BLOCK_SIZE);
+		return block;
+	}
+
+	/**
+		Returns `block` to be written to, cloning it first if it's shared with another copy of the list
+	 */
+	std::vector<T> &mutableBlock(size_t block) {
+		if( blocks[block].use_count() > 1 ) {
+			std::shared_ptr< std::vector<T> > clone = newBlock();
+			clone->assign(blocks[block]->begin(), blocks[block]->end());
+			blocks[block] = std::move(clone);
+		}
+		return *blocks[block];
+	}
+
+	/**
+		Returns (block, offset within block) of position `pos`, which has to be lower than size()
+	 */
+	std::pair<size_t, size_t> locate(size_t pos) const {
+		size_t node = 0;
+		size_t step = 1;
+		while( step * 2 <= blocks.size() ) {
+			step *= 2;
+		}
+		for( ; step > 0; step /= 2 ) {
+			if( node + step <= blocks.size() && tree[node + step] <= pos ) {
+				node += step;
+				pos -= tree[node];
+			}
+		}
+		return std::make_pair(node, pos);
+	}
+
+	/**
+		Adds `delta` to the size of `block` in the Fenwick tree
+	 */
+	void add(size_t block, std::ptrdiff_t delta) {
+		for( size_t node = block + 1; node < tree.size(); node += node & (~node + 1) ) {
+			tree[node] = (size_t) ((std::ptrdiff_t) tree[node] + delta);
+		}
+	}
+
+	/**
+		Adds the tree node of the last block, which has been added empty
+	 */
+	void appendTreeNode() {
+		if( tree.empty() ) {
+			tree.push_back(0);
+		}
+		size_t node = tree.size();
+		size_t sum = 0;
+		// the new node covers the blocks (node - lowbit(node), node], all but the last are already counted in its children
+		for( size_t child = node - 1; child > node - (node & (~node + 1)); child -= child & (~child + 1) ) {
+			sum += tree[child];
+		}
+		tree.push_back(sum);
+	}
+
+	void rebuildTree() {
+		tree.assign(blocks.size() + 1, 0);
+		for( size_t node = 1; node <= blocks.size(); ++node ) {
+			tree[node] += blocks[node - 1]->size();
+			size_t parent = node + (node & (~node + 1));
+			if( parent <= blocks.size() ) {
+				tree[parent] += tree[node];
+			}
+		}
+	}
+
+};
+
+
+#endif
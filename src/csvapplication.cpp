@@ -144,7 +144,7 @@ CsvApplication::CsvApplication() {
 	searchWin->end();
 
 	// Create Sort Window
-	sortWin = new My_Fl_Small_Window(640,180);
+	sortWin = new My_Fl_Small_Window(640,240);
 	sortWin->end();
 	
 	#ifdef __APPLE__
@@ -182,6 +182,10 @@ CsvApplication::CsvApplication() {
 	try {
 		physMemSize = Helper::getPhysMemSize();
 	} catch(...) {}
+	int sortMemoryPercent = atoi( getPreference(&preferences, TCRUNCHER_PREF_SORT_MEMORY_PERCENT, "0").c_str() );
+	if( sortMemoryPercent > 0 && physMemSize > 0 ) {
+		CsvDataStorage::setSortMemoryLimit( physMemSize / 100 * sortMemoryPercent );
+	}
 
 	plusPng = xpmResizer(ui_icons::icon_plus, macroWinImgButtonSize);
 	minusPng = xpmResizer(ui_icons::icon_minus, macroWinImgButtonSize);
@@ -779,6 +783,7 @@ void CsvApplication::closeWindow(int windowIndex, bool forceClose) {
 		return;
 	if( windows[windowIndex].getWindowSlotUsed() ) {
 		// This window has been in use and is showing
+		windows[windowIndex].stopLoading();
 		windows[windowIndex].storeWindowPreferences();
 		My_Fl_Double_Window *nextWinPtr = (My_Fl_Double_Window *) Fl::next_window(windows[windowIndex].win);
 		if( nextWinPtr == NULL && !forceClose ) {
@@ -1438,7 +1443,7 @@ void CsvApplication::showPreview(struct previewTableStruct previewTable) {
 	parser->parseCsvStream(previewTable.input, previewTable.table->getStorage(), previewTable.definition, TCRUNCHER_MAX_PREVIEW_ROWS);
 	// previewTable.table->getStorage().dump(10,true);
 	previewTable.table->updateInternals();
-	previewTable.grid->rows( previewTable.table->getNumberRows() );
+	previewTable.grid->setTableRows( previewTable.table->getNumberRows() );
 	previewTable.grid->cols( previewTable.table->getNumberCols() );
 	
 	delete parser;
@@ -1457,7 +1462,7 @@ void CsvApplication::setFocusByWinIndex(int winIndex) {
 }
 
 void CsvApplication::copySelection() {
-	table_index_t row_top, row_bottom, col_top, col_bottom;
+	int row_top, row_bottom, col_top, col_bottom;
 	std::string copy = "";
 	std::vector<std::string> vec;
 	std::vector<std::vector<std::string>> block;
@@ -1483,7 +1488,7 @@ void CsvApplication::copySelection() {
 void CsvApplication::paste(bool askUser, bool fillSelection) {
 	std::vector<std::vector<std::string>> block;
 	CsvDataStorage localStorage;
-	int block_rows, block_cols;
+	table_index_t block_rows, block_cols;
 	int row_top, row_bottom, col_top, col_bottom;
 	
 	windows[topWindow].grid->get_selection(row_top, col_top, row_bottom, col_bottom);
@@ -1573,8 +1578,8 @@ localStorage.dump();
 		block_cols = localStorage.columns();
 		if( block_cols ) {
 			windows[topWindow].table->resizeTable(row_top + block_rows, col_top + block_cols);
-			for( int i = 0; i < block_rows; ++i ) {
-				for( int j = 0; j < block_cols; ++j ) {
+			for( table_index_t i = 0; i < block_rows; ++i ) {
+				for( table_index_t j = 0; j < block_cols; ++j ) {
 					windows[topWindow].table->setCell(localStorage.get(i,j), row_top + i, col_top + j );
 					// windows[topWindow].grid->redraw();
 					// Fl::check();
@@ -1644,14 +1649,14 @@ void CsvApplication::find_substring_CB(Fl_Widget *, long data) {
 		app.searchWin->hide();
 		return;
 	}
-	int row, col;
-	int startFindRow, startFindCol;
-	std::tuple<int, int> found;
+	table_index_t row, col;
+	table_index_t startFindRow, startFindCol;
+	std::tuple<table_index_t, table_index_t> found;
 	std::string query(app.searchInput->value());
 	int winIndex = app.getTopWindow();
 	bool caseSensitive = true;
 	bool useRegex = false;
-	std::vector<int> sel = windows[winIndex].grid->getSelection();
+	std::vector<table_index_t> sel = windows[winIndex].grid->getSelection();
 	if( app.ignoreCase->value() ) {
 		caseSensitive = false;
 	}
@@ -1676,7 +1681,11 @@ void CsvApplication::find_substring_CB(Fl_Widget *, long data) {
 	app.hideImWorkingWindow();
 	row = std::get<0>(found);
 	col = std::get<1>(found);
-	if( row != -1 && col != -1 ) {
+	if( row != -1 && col != -1 && !windows[winIndex].grid->isDisplayed(row) ) {
+		// the next search continues after this match
+		app.lastFound = found;
+		app.searchWinLabel->copy_label( CsvGrid::beyondGridMessage(row).c_str() );
+	} else if( row != -1 && col != -1 ) {
 		app.lastFound = found;
 		windows[winIndex].grid->setVisibleArea(row, col);
 		windows[winIndex].grid->redraw();
@@ -1696,27 +1705,31 @@ void CsvApplication::find_substring_CB(Fl_Widget *, long data) {
  *	Returns number of replacements
  */
 int CsvApplication::find_replace(bool callFindNext) {
-	int row_top, row_bottom, col_top, col_bottom;
-	int startFindRow, startFindCol;
+	table_index_t startFindRow, startFindCol;
 	int numReplaces;
 	std::string query(app.searchInput->value());
 	std::string replace(app.replaceInput->value());
 	int winIndex = app.getTopWindow();
 	bool caseSensitive = true;
 	bool useRegex = false;
+	if( windows[winIndex].isLoading() ) {
+		app.searchWinLabel->copy_label("Still loading the file.");
+		app.searchWinLabel->redraw();
+		return 0;
+	}
 	if( app.ignoreCase->value() ) {
 		caseSensitive = false;
 	}
 	if( app.useRegex->value() ) {
 		useRegex = true;
 	}
-	windows[winIndex].grid->get_selection(row_top, col_top, row_bottom, col_bottom);
+	std::vector<table_index_t> sel = windows[winIndex].grid->getSelection();
 	if( std::get<0>(app.lastFound) >= 0 && std::get<1>(app.lastFound) >= 0 ) {
 		startFindRow = std::get<0>(app.lastFound);
 		startFindCol = std::get<1>(app.lastFound);
 	} else {
-		startFindRow = row_top;
-		startFindCol = col_top;
+		startFindRow = sel[0];
+		startFindCol = sel[1];
 	}
 	app.showImWorkingWindow("Replacing ...");
 	windows[winIndex].addUndoStateTable("Replace");
@@ -1750,11 +1763,11 @@ void CsvApplication::find_replaceFind_CB(Fl_Widget *, void *) {
  *	Flags all rows where "Find" is found if data == CsvApplication::ReplaceAllType::FLAG
  */
 void CsvApplication::find_replaceAll_CB(Fl_Widget *, long data) {
-	int row_top, row_bottom, col_top, col_bottom;
+	table_index_t row_top, row_bottom, col_top, col_bottom;
 	int numReplaces = 0;
-	int allReplaces = 0;
-	int allChangedCells = 0;
-	int row, col;
+	table_index_t allReplaces = 0;
+	table_index_t allChangedCells = 0;
+	table_index_t row, col;
 	std::string msg;
 	std::string query(app.searchInput->value());
 	std::string replace(app.replaceInput->value());
@@ -1762,6 +1775,11 @@ void CsvApplication::find_replaceAll_CB(Fl_Widget *, long data) {
 	long long allCellCounter = 0, allCells = 0;
 	bool caseSensitive = true;
 	bool useRegex = false;
+	if( windows[winIndex].isLoading() ) {
+		app.searchWinLabel->copy_label("Still loading the file.");
+		app.searchWinLabel->redraw();
+		return;
+	}
 	if( app.ignoreCase->value() ) {
 		caseSensitive = false;
 	}
@@ -1777,12 +1795,18 @@ void CsvApplication::find_replaceAll_CB(Fl_Widget *, long data) {
 	} else if( data == CsvApplication::ReplaceAllType::FLAG ) {
 		app.showImWorkingWindow("Flagging ...");
 		app.searchWinLabel->copy_label("Start flagging ...");
+		windows[winIndex].addUndoStateFlags("Flag Rows");
 	} else if( data == CsvApplication::ReplaceAllType::UNFLAG ) {
 		app.showImWorkingWindow("Unflagging ...");
 		app.searchWinLabel->copy_label("Start unflagging ...");
+		windows[winIndex].addUndoStateFlags("Unflag Rows");
 	}
 
-	windows[winIndex].grid->get_selection(row_top, col_top, row_bottom, col_bottom);
+	std::vector<table_index_t> sel = windows[winIndex].grid->getSelection();
+	row_top = sel[0];
+	col_top = sel[1];
+	row_bottom = sel[2];
+	col_bottom = sel[3];
 	if( row_top == row_bottom && col_top == col_bottom ) {
 		row_top = 0;
 		col_top = 0;
@@ -1791,7 +1815,7 @@ void CsvApplication::find_replaceAll_CB(Fl_Widget *, long data) {
 	}
 
 	allCellCounter = 0;
-	allCells = (col_bottom - col_top + 1) * (row_bottom - row_top + 1);
+	allCells = (long long) (col_bottom - col_top + 1) * (row_bottom - row_top + 1);
 	if( allCells > 0 ) {
 		for( col = col_top; col <= col_bottom; ++col) {
 			for( row = row_top; row <= row_bottom; ++row) {
@@ -1853,9 +1877,11 @@ void CsvApplication::find_replaceAll_CB(Fl_Widget *, long data) {
  * Sort table by column
  */
 void CsvApplication::sort(unsigned int column) {
-	Fl_Choice *colChoice;
-	Fl_Choice *orderChoice;
-	Fl_Choice *typeChoice;
+	const int SORT_LEVELS = 3;								// sort by a column, then by up to two more
+	Fl_Choice *colChoice[SORT_LEVELS];
+	Fl_Choice *orderChoice[SORT_LEVELS];
+	Fl_Choice *typeChoice[SORT_LEVELS];
+	std::pair<Fl_Choice *, int> columnTypes[SORT_LEVELS];	// type choice and number of entries before the first column
 	My_Fl_Button *sortButton;
 	int windowIndex = getTopWindow();
 	std::tuple<Fl_Widget *, Fl_Widget *, Fl_Widget *> widgets;
@@ -1874,31 +1900,43 @@ void CsvApplication::sort(unsigned int column) {
 	sortWin->callback(doSortWinCB);
 	
 	sortWin->begin();
-	colChoice = new Fl_Choice(90, 30, 120, 25, "Column: ");
 	if( column >= windows[windowIndex].table->headerRow->size() )
 		column = 0;
-	for( size_t c = 0; c < windows[windowIndex].table->headerRow->size(); ++c ) {
-		colChoice->add(windows[windowIndex].table->getHeaderCell(c,false).c_str());
-	}
-	colChoice->value(column);
-	colChoice->labelcolor(ColorThemes::getColor(app.getTheme(), "win_text"));
+	for( int level = 0; level < SORT_LEVELS; ++level ) {
+		int y = 30 + level * 35;
+		// the first level is preselected, the others start with "–" (don't sort by a further column)
+		colChoice[level] = new Fl_Choice(90, y, 120, 25, level == 0 ? "Sort by: " : "Then by: ");
+		if( level > 0 ) {
+			colChoice[level]->add("–");
+		}
+		for( size_t c = 0; c < windows[windowIndex].table->headerRow->size(); ++c ) {
+			colChoice[level]->add(windows[windowIndex].table->getHeaderCell(c,false).c_str());
+		}
+		colChoice[level]->value(level == 0 ? column : 0);
+		colChoice[level]->labelcolor(ColorThemes::getColor(app.getTheme(), "win_text"));
+
+		orderChoice[level] = new Fl_Choice(280, y, 120, 25, "Order: ");
+		orderChoice[level]->add("Ascending");
+		orderChoice[level]->add("Descending");
+		orderChoice[level]->value(0);
+		orderChoice[level]->labelcolor(ColorThemes::getColor(app.getTheme(), "win_text"));
+		
+		typeChoice[level] = new Fl_Choice(470, y, 120, 25, "Type: ");
+		typeChoice[level]->add("Numeric");
+		typeChoice[level]->add("String");
+		typeChoice[level]->add("String (ignore case)");
+		typeChoice[level]->add("Natural");
+		typeChoice[level]->value(level == 0 ? searchType : 1);
+		typeChoice[level]->labelcolor(ColorThemes::getColor(app.getTheme(), "win_text"));
 
-	orderChoice = new Fl_Choice(280, 30, 120, 25, "Order: ");
-	orderChoice->add("Ascending");
-	orderChoice->add("Descending");
-	orderChoice->value(0);
-	orderChoice->labelcolor(ColorThemes::getColor(app.getTheme(), "win_text"));
-	
-	typeChoice = new Fl_Choice(470, 30, 120, 25, "Type: ");
-	typeChoice->add("Numeric");
-	typeChoice->add("String");
-	typeChoice->add("String (ignore case)");
-	typeChoice->value(searchType);
-	typeChoice->labelcolor(ColorThemes::getColor(app.getTheme(), "win_text"));
+		// choosing a column guesses its type
+		columnTypes[level] = {typeChoice[level], level == 0 ? 0 : 1};
+		colChoice[level]->callback(sortColumnCB, &columnTypes[level]);
+	}
 
-	std::get<0>(widgets) = colChoice;
-	std::get<1>(widgets) = orderChoice;
-	std::get<2>(widgets) = typeChoice;
+	std::get<0>(widgets) = colChoice[0];
+	std::get<1>(widgets) = orderChoice[0];
+	std::get<2>(widgets) = typeChoice[0];
 
 	struct My_Fl_Button::buttonColorStruct colorsHighlightButton;
 	colorsHighlightButton.background = ColorThemes::getColor(app.getTheme(), "hightlight_button_bg");
@@ -1906,7 +1944,7 @@ void CsvApplication::sort(unsigned int column) {
 	colorsHighlightButton.border = ColorThemes::getColor(app.getTheme(), "hightlight_button_border");
 	colorsHighlightButton.windowBg = ColorThemes::getColor(app.getTheme(), "win_bg");
 	colorsHighlightButton.borderWidth = ColorThemes::getColor(app.getTheme(), "highlight_button_border_width");
-	sortButton = new My_Fl_Button(90,100,100,24, "Sort");
+	sortButton = new My_Fl_Button(90,170,100,24, "Sort");
 	sortButton->colors = colorsHighlightButton;
 	sortButton->callback(doSortCB, &widgets);
 
@@ -1922,24 +1960,29 @@ void CsvApplication::sort(unsigned int column) {
 	
 	// do sort
 	if( sortWin->dataExchange == 0 ) {
+		std::vector<CsvDataStorage::SortColumn> sortColumns;
+		for( int level = 0; level < SORT_LEVELS; ++level ) {
+			table_index_t sortColumn = colChoice[level]->value() - (level == 0 ? 0 : 1);
+			if( sortColumn >= 0 ) {
+				sortColumns.push_back( {sortColumn, orderChoice[level]->value() == 0 ? true : false, typeChoice[level]->value()} );
+			}
+		}
 		windows[windowIndex].setChanged(true);
 		windows[windowIndex].setUsed(true);
 		showImWorkingWindow("Sorting ...");
-		windows[windowIndex].addUndoStateTable("Sort Table");
-		windows[windowIndex].table->sortTable(
-			colChoice->value(),
-			orderChoice->value() == 0 ? true : false,
-			typeChoice->value()
-		);
+		windows[windowIndex].addUndoStateOrder("Sort Table");
+		windows[windowIndex].table->sortTable(sortColumns);
 		hideImWorkingWindow();
 		windows[windowIndex].grid->redraw();
 		Fl::check();
 	}
 	sortWin->hide();
 	
-	delete colChoice;
-	delete orderChoice;
-	delete typeChoice;
+	for( int level = 0; level < SORT_LEVELS; ++level ) {
+		delete colChoice[level];
+		delete orderChoice[level];
+		delete typeChoice[level];
+	}
 	delete sortButton;
 	// restore active window
 	if( topWin ) {
@@ -1948,6 +1991,17 @@ void CsvApplication::sort(unsigned int column) {
 		topWin->take_focus();
 	}
 }
+/*
+ *	Sets the type choice of a sort level to the guessed type of the chosen column. `data` points to a pair of
+ *	the type choice and the number of entries before the first column.
+ */
+void CsvApplication::sortColumnCB(Fl_Widget *widget, void *data) {
+	std::pair<Fl_Choice *, int> *columnType = (std::pair<Fl_Choice *, int> *) data;
+	table_index_t column = ((Fl_Choice *) widget)->value() - columnType->second;
+	if( column >= 0 ) {
+		columnType->first->value( windows[app.getTopWindow()].table->isNumericColumn(column, 1000000) ? 0 : 1 );
+	}
+}
 void CsvApplication::doSortCB(Fl_Widget *, void *) {
 	app.sortWin->dataExchange = 0;
 	app.sortWin->hide();
@@ -1972,9 +2026,10 @@ void CsvApplication::doSortWinCB(Fl_Widget *, long data) {
  */
 void CsvApplication::flagSelectedRowsCB() {
 	int topWinIndex = app.getTopWindow();
-	std::vector<int> selection = windows[topWinIndex].grid->getSelection();
+	std::vector<table_index_t> selection = windows[topWinIndex].grid->getSelection();
 	showImWorkingWindow("Flagging rows ...");
-	for( int r = selection[0]; r <= selection[2]; ++r ) {
+	windows[topWinIndex].addUndoStateFlags("Flag Rows");
+	for( table_index_t r = selection[0]; r <= selection[2]; ++r ) {
 		windows[topWinIndex].table->flagRow(r, true);
 	}
 	hideImWorkingWindow();
@@ -1991,7 +2046,7 @@ void CsvApplication::unflagRowsCB() {
 	std::string msg;
 	int choice;
 	int topWinIndex = app.getTopWindow();
-	int countFlaggedRows = windows[topWinIndex].table->countFlaggedRows();
+	table_index_t countFlaggedRows = windows[topWinIndex].table->countFlaggedRows();
 	if( countFlaggedRows == 0 ) {
 		myFlChoice("Info", "There are no flagged rows.", {"Okay"});
 		return;
@@ -2002,6 +2057,7 @@ void CsvApplication::unflagRowsCB() {
 		return;
 	}
 	showImWorkingWindow("Unflagging rows ...");
+	windows[topWinIndex].addUndoStateFlags("Unflag Rows");
 	windows[topWinIndex].table->clearFlags();
 	hideImWorkingWindow();
 	windows[topWinIndex].grid->redraw();
@@ -2016,6 +2072,7 @@ void CsvApplication::unflagRowsCB() {
  */
 void CsvApplication::invertFlaggedCB() {
 	showImWorkingWindow("Inverting flagged rows ...");
+	windows[app.getTopWindow()].addUndoStateFlags("Invert Flagged Rows");
 	windows[app.getTopWindow()].table->invertFlags();
 	hideImWorkingWindow();
 	windows[app.getTopWindow()].grid->redraw();
@@ -2024,14 +2081,13 @@ void CsvApplication::invertFlaggedCB() {
 
 
 /**
- 	Deletes all rows that have beend flagged
-	Flag 'deleteFlagged = false' doesn't work right now!!
+ 	Deletes all rows that have beend flagged – or all unflagged rows if 'deleteFlagged' is false
 
  */
 void CsvApplication::deleteFlaggedCB(bool deleteFlagged) {
 	std::string msg;
 	int choice;
-	int countFlaggedRows = windows[app.getTopWindow()].table->countFlaggedRows();
+	table_index_t countFlaggedRows = windows[app.getTopWindow()].table->countFlaggedRows();
 	if( countFlaggedRows == 0 ) {
 		myFlChoice("Info", "There are no flagged rows.", {"Okay"});
 		return;
@@ -2055,7 +2111,7 @@ void CsvApplication::deleteFlaggedCB(bool deleteFlagged) {
 	}
 	windows[app.getTopWindow()].table->deleteFlaggedRows(deleteFlagged);
 	hideImWorkingWindow();
-	windows[app.getTopWindow()].grid->rows( windows[app.getTopWindow()].table->getNumberRows() );
+	windows[app.getTopWindow()].grid->setTableRows( windows[app.getTopWindow()].table->getNumberRows() );
 	windows[app.getTopWindow()].grid->redraw();
 	Fl::check();
 }
@@ -2423,7 +2479,7 @@ void CsvApplication::moveCols(bool right) {
 	if( (right && col_bottom < windows[winIndex].table->getNumberCols() - 1 && col_top >= 0) ||
 		(!right && col_bottom < windows[winIndex].table->getNumberCols() && col_top > 0 ) ) {
 		showImWorkingWindow("Moving column(s) ...");
-		windows[winIndex].addUndoStateTable("Move column(s)");
+		windows[winIndex].addUndoStateMoveColumns(col_top, col_bottom, right, "Move column(s)");
 		windows[winIndex].setChanged(true);
 		windows[winIndex].setUsed(true);
 		windows[winIndex].table->moveCols(col_top, col_bottom, right);
@@ -2443,7 +2499,8 @@ void CsvApplication::addCol(bool before) {
 	int winIndex = app.getTopWindow();
 	windows[winIndex].grid->get_selection(row_top, col_top, row_bottom, col_bottom);
 	showImWorkingWindow("Adding column ...");
-	windows[winIndex].addUndoStateTable("Add column");
+	table_index_t newCol = std::clamp( (table_index_t) (before ? col_top : col_bottom), (table_index_t) 0, windows[winIndex].table->getNumberCols() - 1 ) + (before ? 0 : 1);
+	windows[winIndex].addUndoStateColumns(newCol, 1, 0, -1, "Add column");
 	windows[winIndex].setChanged(true);
 	windows[winIndex].setUsed(true);
 	if( before ) {
@@ -2453,7 +2510,7 @@ void CsvApplication::addCol(bool before) {
 		windows[winIndex].table->addCol(col_bottom, false);
 	}
 	hideImWorkingWindow();
-	windows[winIndex].grid->rows( windows[winIndex].table->getNumberRows() );
+	windows[winIndex].grid->setTableRows( windows[winIndex].table->getNumberRows() );
 	windows[winIndex].grid->cols( windows[winIndex].table->getNumberCols() );
 	windows[winIndex].grid->redraw();
 	Fl::check();
@@ -2465,7 +2522,8 @@ void CsvApplication::addRow(bool before) {
 	int winIndex = app.getTopWindow();
 	windows[winIndex].grid->get_selection(row_top, col_top, row_bottom, col_bottom);
 	showImWorkingWindow("Adding row ...");
-	windows[winIndex].addUndoStateTable("Add row");
+	table_index_t newRow = std::clamp( (table_index_t) (before ? row_top : row_bottom), (table_index_t) 0, windows[winIndex].table->getNumberRows() - 1 ) + (before ? 0 : 1);
+	windows[winIndex].addUndoStateRows(newRow, 1, 0, "Add row");
 	windows[winIndex].setChanged(true);
 	windows[winIndex].setUsed(true);
 	if( before ) {
@@ -2475,7 +2533,7 @@ void CsvApplication::addRow(bool before) {
 		windows[winIndex].table->addRow(row_bottom, false);		
 	}
 	hideImWorkingWindow();
-	windows[winIndex].grid->rows( windows[winIndex].table->getNumberRows() );
+	windows[winIndex].grid->setTableRows( windows[winIndex].table->getNumberRows() );
 	windows[winIndex].grid->cols( windows[winIndex].table->getNumberCols() );
 	windows[winIndex].grid->redraw();
 	Fl::check();
@@ -2507,13 +2565,15 @@ void CsvApplication::delCols() {
 	
 	newCol = col_top > 0 ? col_top - 1 : 0;
 	showImWorkingWindow("Deleting column(s) ...");
-	windows[winIndex].addUndoStateTable("Delete column(s)");
+	if( col_bottom - col_top + 1 < windows[winIndex].table->getNumberCols() ) {		// CsvTable::delCols() doesn't delete all columns
+		windows[winIndex].addUndoStateColumns(col_top, 0, col_bottom - col_top + 1, -1, "Delete column(s)");
+	}
 	windows[winIndex].setChanged(true);
 	windows[winIndex].setUsed(true);
 	windows[winIndex].table->delCols(col_top, col_bottom);
 	hideImWorkingWindow();
 	windows[winIndex].grid->updateSelection(row_top, newCol, row_bottom, newCol);
-	windows[winIndex].grid->rows( windows[winIndex].table->getNumberRows() );
+	windows[winIndex].grid->setTableRows( windows[winIndex].table->getNumberRows() );
 	windows[winIndex].grid->cols( windows[winIndex].table->getNumberCols() );
 	windows[winIndex].grid->redraw();
 	Fl::check();
@@ -2545,13 +2605,15 @@ void CsvApplication::delRows() {
 
 	newRow = row_top > 0 ? row_top - 1 : 0;
 	showImWorkingWindow("Deleting row(s) ...");
-	windows[winIndex].addUndoStateTable("Delete row(s)");
+	if( row_bottom - row_top + 1 < windows[winIndex].table->getNumberRows() ) {		// CsvTable::delRows() doesn't delete all rows
+		windows[winIndex].addUndoStateRows(row_top, 0, row_bottom - row_top + 1, "Delete row(s)");
+	}
 	windows[winIndex].setChanged(true);
 	windows[winIndex].setUsed(true);
 	windows[winIndex].table->delRows(row_top, row_bottom);
 	windows[winIndex].grid->updateSelection(newRow, col_top, newRow, col_bottom);
 	hideImWorkingWindow();
-	windows[winIndex].grid->rows( windows[winIndex].table->getNumberRows() );
+	windows[winIndex].grid->setTableRows( windows[winIndex].table->getNumberRows() );
 	windows[winIndex].grid->cols( windows[winIndex].table->getNumberCols() );
 	windows[winIndex].grid->redraw();
 	Fl::check();
@@ -2604,7 +2666,9 @@ void CsvApplication::splitCol() {
 		windows[windowIndex].setChanged(true);
 		windows[windowIndex].setUsed(true);
 		showImWorkingWindow("Splitting ...");
-		windows[windowIndex].addUndoStateTable("Split Column");
+		if( colChoice->value() >= 0 && colChoice->value() < windows[windowIndex].table->getNumberCols() ) {
+			windows[windowIndex].addUndoStateColumns(colChoice->value() + 1, 1, 0, colChoice->value(), "Split Column");
+		}
 		app.lastSplitString = splitStringBox->value();
 		windows[windowIndex].table->splitColumn(colChoice->value(), app.lastSplitString);
 		hideImWorkingWindow();
@@ -2631,7 +2695,7 @@ void CsvApplication::splitColumn_Cancel_CB(Fl_Widget *widget, void *data) {
 void CsvApplication::mergeCols() {
 	Fl_Choice *colChoice;
 	int windowIndex = getTopWindow();
-	std::vector<int> sel = windows[windowIndex].grid->getSelection();
+	std::vector<table_index_t> sel = windows[windowIndex].grid->getSelection();
 	int column = sel[1];
 	int callbackDataExchange = 0;
 
@@ -2678,7 +2742,9 @@ void CsvApplication::mergeCols() {
 		windows[windowIndex].setChanged(true);
 		windows[windowIndex].setUsed(true);
 		showImWorkingWindow("Merging ...");
-		windows[windowIndex].addUndoStateTable("Merge Column");
+		if( colChoice->value() >= 0 && colChoice->value() < windows[windowIndex].table->getNumberCols() - 1 ) {
+			windows[windowIndex].addUndoStateColumns(colChoice->value() + 1, 0, 1, colChoice->value(), "Merge Column");
+		}
 		app.lastGlueString = mergeStringBox->value();
 		windows[windowIndex].table->mergeColumns(colChoice->value(), app.lastGlueString);
 		hideImWorkingWindow();
@@ -2705,9 +2771,9 @@ void CsvApplication::jumpToRow() {
 	std::string jumpString, rowString = "", colString = "";
 	size_t delimiter_pos;
 	int retOkay;
-	int row = -1, col;
+	table_index_t row = -1, col;
 	int winIndex = app.getTopWindow();
-	std::vector<int> sel = windows[winIndex].grid->getSelection();
+	std::vector<table_index_t> sel = windows[winIndex].grid->getSelection();
 	col = sel[1];
 	std::tie(retOkay, jumpString) = myFlAskString("Jump to Row", "Jump");
 	if( retOkay ) {
@@ -2724,7 +2790,7 @@ void CsvApplication::jumpToRow() {
 				} else {
 					// No custom headers: interpret colString as column number
 					try {
-						col = std::stoi(colString);
+						col = std::stoll(colString);
 						--col;
 					} catch(...) {
 						col = Helper::genericColumnNameToIndex(colString);
@@ -2738,7 +2804,7 @@ void CsvApplication::jumpToRow() {
 			rowString = jumpString;
 		}
 		try {
-			row = std::stoi(rowString);
+			row = std::stoll(rowString);
 			--row;
 		} catch(...) {
 			row = -1;
@@ -2747,9 +2813,11 @@ void CsvApplication::jumpToRow() {
 			row = sel[0];
 		}
 	}
-	if( row >= 0 && row < windows[winIndex].table->getNumberRows() ) {
+	if( windows[winIndex].grid->isDisplayed(row) ) {
 		windows[winIndex].grid->set_selection(row,col,row,col);
 		windows[winIndex].grid->setVisibleArea(row, col);
+	} else if( row >= 0 && row < windows[winIndex].table->getNumberRows() ) {
+		myFlChoice("Info", CsvGrid::beyondGridMessage(row), {"Okay"});
 	} else if( retOkay != 0 ) {
 		myFlChoice("Warning", "Invalid row number!", {"Okay"});
 	}
@@ -2757,9 +2825,9 @@ void CsvApplication::jumpToRow() {
 
 
 void CsvApplication::jumpToFlaggedRow(bool direction) {
-	int newRow;
+	table_index_t newRow;
 	int winIndex = app.getTopWindow();
-	std::vector<int> sel = windows[winIndex].grid->getSelection();
+	std::vector<table_index_t> sel = windows[winIndex].grid->getSelection();
 	if( windows[winIndex].table->countFlaggedRows() == 0 ) {
 		myFlChoice("Information", "No flagged rows found.", {"Okay"});
 		return;
@@ -2769,14 +2837,25 @@ void CsvApplication::jumpToFlaggedRow(bool direction) {
 	} else {
 		newRow = windows[winIndex].table->getPrevFlaggedRow(sel[0]);
 	}
-	if( newRow >= 0 && newRow < windows[winIndex].table->getNumberRows() ) {
+	if( windows[winIndex].grid->isDisplayed(newRow) ) {
 		windows[winIndex].grid->set_selection(newRow,sel[1],newRow,sel[1]);
 		windows[winIndex].grid->setVisibleArea(newRow, sel[1]);
+	} else if( newRow >= 0 && newRow < windows[winIndex].table->getNumberRows() ) {
+		myFlChoice("Info", CsvGrid::beyondGridMessage(newRow), {"Okay"});
 	}
 }
 
 
 void CsvApplication::switchHeaderRowCB(Fl_Widget *, void *) {
+	int winIndex = app.getTopWindow();
+	if( windows[winIndex].table->getNumberRows() > 1 || windows[winIndex].table->customHeaderRowShown() ) {
+		windows[winIndex].addUndoStateHeaderRow("Switch Header Row");
+	}
+	app.switchHeaderRow();
+}
+
+
+void CsvApplication::switchHeaderRow() {
 	int winIndex = app.getTopWindow();
 	if( windows[winIndex].table->getNumberRows() <= 1 && !windows[winIndex].table->customHeaderRowShown() ) {
 		windows[winIndex].showHeaderCheckbox->clear();
@@ -2791,7 +2870,7 @@ void CsvApplication::switchHeaderRowCB(Fl_Widget *, void *) {
 		windows[winIndex].showHeaderCheckbox->set();
 	}
 	windows[winIndex].table->switchHeader();
-	windows[winIndex].grid->rows( windows[winIndex].table->getNumberRows() );
+	windows[winIndex].grid->setTableRows( windows[winIndex].table->getNumberRows() );
 	windows[winIndex].grid->redraw();
 	Fl::check();
 }
@@ -2851,6 +2930,7 @@ void CsvApplication::checkDataConsistency() {
 	}
 	// Check data consistency of column in col_top
 	showImWorkingWindow("Checking data consistency ...");
+	windows[winIndex].addUndoStateFlags("Check Data Consistency");
 	size_t countInconsistentRows = windows[winIndex].table->flagInconsistentData(col_top);
 	hideImWorkingWindow();
 	windows[winIndex].grid->redraw();
@@ -3248,7 +3328,7 @@ void CsvApplication::myFlAskStringOkCB(Fl_Widget *widget, void *) {
 	((Fl_Widget *) parent)->hide();
 }
 
-std::tuple<int, int> CsvApplication::lastFoundPosition() {
+std::tuple<table_index_t, table_index_t> CsvApplication::lastFoundPosition() {
 	return lastFound;
 }
 
@@ -3416,7 +3496,7 @@ void CsvApplication::editSingleCell() {
 	int buttonHeight = 24;
 	int margin = 20;
 	int winIndex = getTopWindow();
-	std::vector<int> selected = windows[winIndex].grid->getSelection();
+	std::vector<table_index_t> selected = windows[winIndex].grid->getSelection();
 	if( selected[0] < 0 || selected[0] >= windows[winIndex].table->getNumberRows() || selected[1] < 0 || selected[1] >= windows[winIndex].table->getNumberCols() ) {
 		return;
 	}
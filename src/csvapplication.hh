@@ -192,6 +192,7 @@ public:
 	static void executeMacroCB(Fl_Widget *, void *data);				// TODO public?
 	static void insertLoopButtonCB(Fl_Widget *, void *data);			// TODO public?
 	static void doSortCB(Fl_Widget *, void *);
+	static void sortColumnCB(Fl_Widget *widget, void *data);
 	static void doSortWinCB(Fl_Widget *, long data);
 	std::string getPreference(Fl_Preferences *pref, std::string key, std::string def);
 	void moveCols(bool right);
@@ -206,6 +207,7 @@ public:
 	static void mergeColumn_CB(Fl_Widget *widget, void *data);
 	static void mergeColumn_Cancel_CB(Fl_Widget *widget, void *data);
 	static void switchHeaderRowCB(Fl_Widget *, void *);
+	void switchHeaderRow();											// switches the header row of the top window without an undo state
     static void arrangeColumnsCB(Fl_Widget *, void *);
 	static void aboutCB(Fl_Widget *, void *);
 	void changeFontSize(int changeMode);
@@ -223,7 +225,7 @@ public:
 	std::string getFont();
 	static int myFlChoice(std::string title, std::string message, std::vector<std::string> options, int buttonWidth=100, int windowHeight=140);
 	static std::pair<int,std::string> myFlAskString(std::string title, std::string buttonText, int buttonWidth=80);
-	std::tuple<int, int> lastFoundPosition();
+	std::tuple<table_index_t, table_index_t> lastFoundPosition();
 	void jumpToRow();
 	void jumpToFlaggedRow(bool direction = true);
 	void checkUpdate(bool ignorePref = false);
@@ -292,7 +294,7 @@ private:
 	std::string workDir;
 	std::string theme = "Bright";
 	std::string gridFont = "Helvetica";
-	std::tuple<int, int> lastFound = {-1,-1};			// last cell a search has been succesful
+	std::tuple<table_index_t, table_index_t> lastFound = {-1,-1};	// last cell a search has been succesful
 	// macroWin
 	int lastMacroWinX = -1;								// stores the position of the macro window
 	int lastMacroWinY = -1;
@@ -25,10 +25,11 @@
 
 /*
 
-	Change tableData from vec-vec-string to vec-string
-	* All lines marked with CHANGE have to be changed when switching to vec-string
-	* Row strings don't need to be of full length. Size is determined by `numColumns`.
+	Change tableData from vec-vec-string to vec-string to row spans into slabs
+	* Row strings don't need to be of full length. Size is determined by `columnMap`.
 	* csvparser.cpp: Look for occurrences of my delimiter octet in input strings.
+	* A RowSpan is valid as long as its slab exists: compact() replaces all slabs.
+	* Copies share slabs and row blocks (copy on write): never write into a slab that's shared.
 
 
 */
@@ -50,30 +51,88 @@ CsvDataStorage::CsvDataStorage(table_index_t R, table_index_t C) {
 }
 
 
+/**
+	Slab(size_t capacity)
+ */
+CsvDataStorage::Slab::Slab(size_t capacity) : words(new uint32_t[(capacity + 3) / 4]), capacity(capacity) {
+}
+
+
+/**
+	Dictionary(table_index_t column)
+
+	Code 0 is always the empty string, so empty records can be stored with all codes set to 0.
+	The codes are looked up by a hash table of their own that compares against `values`, so looking up a
+	string_view doesn't copy it and copies of the dictionary need no fix-up.
+ */
+CsvDataStorage::Dictionary::Dictionary(table_index_t column) : column(column), values(1) {
+	rehash(16);
+}
+
+uint16_t CsvDataStorage::Dictionary::encode(std::string_view value) {
+	size_t slot = probe(value);
+	if( slots[slot] != ESCAPE_CODE || values.size() >= ESCAPE_CODE ) {
+		return slots[slot];
+	}
+	uint16_t code = (uint16_t) values.size();
+	values.emplace_back(value);
+	slots[slot] = code;
+	if( 2 * values.size() > slots.size() ) {
+		rehash(2 * slots.size());
+	}
+	return code;
+}
+
+uint16_t CsvDataStorage::Dictionary::find(std::string_view value) const {
+	return slots[probe(value)];
+}
+
+size_t CsvDataStorage::Dictionary::probe(std::string_view value) const {
+	size_t mask = slots.size() - 1;
+	size_t slot = std::hash<std::string_view>()(value) & mask;
+	while( slots[slot] != ESCAPE_CODE && values[slots[slot]] != value ) {
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+void CsvDataStorage::Dictionary::rehash(size_t numSlots) {
+	slots.assign(numSlots, ESCAPE_CODE);
+	for( size_t code = 0; code < values.size(); ++code ) {
+		slots[probe(values[code])] = (uint16_t) code;
+	}
+}
+
+
 /**
 	resize(long R, long C = 0)
 
 	Resize to R,C dimensions. Table can grow only, shrinking has to be done by
 	deleteColumns() or deleteRows().
 	If R == 0 or C == 0: this dimension isn't changed
+	Neither dimension touches the existing rows: new rows are stored without any fields and the number of
+	columns is metadata only, as missing fields are read as empty.
  */
 void CsvDataStorage::resize(table_index_t R, table_index_t C) {
 	table_index_t old_rows = rows();
 	table_index_t old_columns = columns();
 
-	if( C > old_columns ) {
-		for( table_index_t i = 0; i < old_rows; ++i) {
-			tableData.at(i) += emptyCellsString(C - old_columns);
-		}
-	}
 	if( R > 0 && R > rows() ) {
-		tableData.resize(R);
-		for( table_index_t i = old_rows; i < R; ++i) {	// add empty vectors into the newly created rows
-			tableData.at(i) = emptyCellsString(C - 1);
+		RowSpan emptyRow = storeRow(std::string());
+		for( table_index_t i = old_rows; i < R; ++i) {	// add empty rows
+			if( i > old_rows ) {
+				emptyRow = storeRow(rowData(emptyRow), emptyRow.length, rowDelimiters(emptyRow), emptyRow.delimiters, rowCodes(emptyRow));
+			}
+			tableData.push_back(emptyRow);
 		}
+		rowsChanged();
 	}
 	if( C > old_columns ) {
-		numColumns = C;
+		// new columns get physical columns no row contains yet, so they are empty without touching the rows
+		for( table_index_t c = old_columns; c < C; ++c ) {
+			columnMap.push_back(physicalColumns++);
+		}
+		updateColumnsInOrder();
 	}
 }
 
@@ -85,8 +144,17 @@ void CsvDataStorage::resize(table_index_t R, table_index_t C) {
  */
 void CsvDataStorage::clear() {
 	tableData.clear();
-	tableData.shrink_to_fit();
-	numColumns = 0;
+	slabs.clear();
+	slabs.shrink_to_fit();
+	liveBytes = 0;
+	deadBytes = 0;
+	columnMap.clear();
+	physicalColumns = 0;
+	columnsInOrder = true;
+	dictionaries.clear();
+	columnSlots.clear();
+	numCodes = 0;
+	numericColumns.clear();
 }
 
 
@@ -106,73 +174,500 @@ table_index_t CsvDataStorage::rows() {
 	Returns number of columns
  */
 table_index_t CsvDataStorage::columns() {
-	return numColumns;
+	return (table_index_t) columnMap.size();
 }
 
 
 
 /**
-	sort(int column, bool ascending, int sortType)
-	sortType 0:Numerical, 1:String, 2:String (ignore case) – default: 1
+	sort(int column, bool ascending, int sortType, SortBackend backend)
+	sortType 0:Numerical, 1:String, 2:String (ignore case), 3:Natural – default: 1
  */
-void CsvDataStorage::sort(table_index_t column, bool ascending, int sortType) {
+void CsvDataStorage::sort(table_index_t column, bool ascending, int sortType, SortBackend backend) {
+	sort( std::vector<SortColumn>{ {column, ascending, sortType} }, backend );
+}
 
-	if( rows() <= 1 || column < 0 || column >= columns() ) {
-		return;
+
+/**
+	sort(std::vector<SortColumn> sortColumns, SortBackend backend)
+
+	Sorts the rows by the first column of `sortColumns`, rows with equal values by the second one and so on.
+	The sort is stable: rows that are equal in all sort columns keep their order. Invalid columns are ignored.
+ */
+void CsvDataStorage::sort(const std::vector<SortColumn> &sortColumns, SortBackend backend) {
+	std::vector<table_index_t> order = sortedOrder(sortColumns, backend);
+	if( !order.empty() ) {
+		reorder(order);
 	}
+}
 
-	long counter = 0;
-	std::sort( tableData.begin(), tableData.end(), [&column, &ascending, &sortType, &counter](const auto& lhs, const auto& rhs) {
-		std::string s1 = getColumn(lhs, column);
-		std::string s2 = getColumn(rhs, column);
-		double d1, d2;
-		std::string lowerS1;
-		std::string lowerS2;
-		if( counter % 50000 == 0 ) {
-			Fl::check();
+
+/**
+	sortedOrder(std::vector<SortColumn> sortColumns, SortBackend backend, std::vector<long> base)
+
+	Returns the order of the rows sorted like sort() does, without changing the storage: element i is the row
+	that comes i-th. The rows are taken in the order of `base` (all rows, by default in storage order), so rows
+	that are equal in all sort columns keep their order within `base`. Returns an empty vector if there's
+	nothing to sort.
+
+	Decorate-sort-undecorate: the keys of every row are extracted once (in parallel), then the positions are
+	sorted by their keys. The first sort column is packed into an integer key stored with the position, which
+	decides most comparisons: the numeric key or the first 8 bytes of the string (inverted for descending order).
+	The values of a dictionary-encoded column are ranked once, so its cells are compared by the ranks of their
+	codes – and the rank is the whole key if it's the first sort column and no value is stored in the rows.
+	The keys are sorted by a parallel merge sort or by a radix sort, `SortBackend::AUTO` takes the radix sort
+	from TCRUNCHER_RADIX_SORT_MIN_ROWS rows on and sorts using temporary files if the keys would exceed the
+	memory budget. All backends give the same order.
+ */
+std::vector<table_index_t> CsvDataStorage::sortedOrder(const std::vector<SortColumn> &sortColumns, SortBackend backend, const std::vector<table_index_t> &base) {
+	std::vector<SortColumn> valid;
+	for( const SortColumn &sortColumn : sortColumns ) {
+		if( sortColumn.column >= 0 && sortColumn.column < columns() ) {
+			valid.push_back(sortColumn);
+		}
+	}
+	if( rows() <= 1 || valid.empty() || (!base.empty() && (table_index_t) base.size() != rows()) ) {
+		return {};
+	}
+	if( backend == SortBackend::EXTERNAL || (backend == SortBackend::AUTO && sortWorkingSet(valid) > sortMemoryBudget()) ) {
+		std::vector<table_index_t> order = sortedOrderExternal(valid, base);
+		if( !order.empty() ) {
+			return order;
+		}
+		// no temporary files available: sort in memory after all
+	}
+
+	// the keys of a single sort column
+	struct ColumnKeys {
+		bool numeric;
+		bool ascending;
+		std::vector<uint64_t> numbers;				// NUMERIC: order-preserving keys, inverted for descending order
+		std::vector<std::string_view> texts;		// STRING: views of the cells or of their sort texts
+		std::vector<std::string> folded;			// sort texts of the cells (if they aren't compared as they are)
+		std::vector<std::string> foldedValues;		// sort texts of the dictionary values
+		std::vector<uint32_t> ranks;				// encoded STRING columns: rank of the cell's dictionary value, NO_RANK if it isn't encoded
+	};
+	static constexpr uint32_t NO_RANK = UINT32_MAX;
+	struct SortItem {
+		uint64_t key;								// key of the first sort column
+		size_t row;									// position within `base`
+	};
+	size_t numRows = tableData.size();
+	std::vector<ColumnKeys> columnKeys(valid.size());
+	std::vector<SortItem> items(numRows);
+
+	for( size_t k = 0; k < valid.size(); ++k ) {
+		ColumnKeys &keys = columnKeys[k];
+		keys.numeric = valid[k].sortType == 0;
+		keys.ascending = valid[k].ascending;
+		if( keys.numeric ) {
+			// NUMERIC: the cells are parsed once by numbers(), cells that aren't numbers count as 0. Integers
+			// stay exact if the column contains no decimals.
+			// TODO make a decimal comma optional
+			const NumericColumn &values = numbers(valid[k].column);
+			bool integers = values.allIntegers();
+			if( k > 0 ) {
+				keys.numbers.resize(numRows);
+			}
+			Helper::parallelFor(numRows, TCRUNCHER_PARALLEL_MIN_ROWS, [&](size_t, size_t from, size_t to) {
+				for( size_t r = from; r < to; ++r ) {
+					size_t R = base.empty() ? r : base[r];
+					uint64_t key = integers ? RadixSort::orderedKey(values.integerAt(R)) : RadixSort::orderedKey(values.realAt(R));
+					key = keys.ascending ? key : ~key;
+					if( k == 0 ) {
+						items[r] = { key, r };
+					} else {
+						keys.numbers[r] = key;
+					}
+				}
+			});
+		} else {
+			// STRING: the cells are compared as they are or by their sortText(). Encoded columns get the sort
+			// texts of their dictionary values once, only escaped values are transformed per row.
+			int sortType = valid[k].sortType;
+			bool ignoreCase = sortType >= 2;
+			table_index_t physical = columnMap[valid[k].column];
+			int32_t slot = slotOf(physical);
+			std::vector<uint32_t> valueRanks;
+			if( slot >= 0 ) {
+				if( ignoreCase ) {
+					for( const std::string &value : dictionaries[slot].values ) {
+						keys.foldedValues.push_back( sortText(sortType, value) );
+					}
+				}
+				const std::vector<std::string> &sortValues = ignoreCase ? keys.foldedValues : dictionaries[slot].values;
+				std::vector<uint16_t> byValue(sortValues.size());
+				for( size_t code = 0; code < byValue.size(); ++code ) {
+					byValue[code] = (uint16_t) code;
+				}
+				std::sort(byValue.begin(), byValue.end(), [&sortValues](uint16_t lhs, uint16_t rhs) {
+					return sortValues[lhs] < sortValues[rhs];
+				});
+				// equal sort texts get the same rank
+				valueRanks.resize(byValue.size());
+				for( size_t i = 0; i < byValue.size(); ++i ) {
+					bool tie = i > 0 && sortValues[byValue[i]] == sortValues[byValue[i - 1]];
+					valueRanks[byValue[i]] = tie ? valueRanks[byValue[i - 1]] : (uint32_t) i;
+				}
+				keys.ranks.resize(numRows);
+			}
+			if( ignoreCase ) {
+				keys.folded.resize(numRows);
+			}
+			keys.texts.resize(numRows);
+			Helper::parallelFor(numRows, TCRUNCHER_PARALLEL_MIN_ROWS, [&](size_t, size_t from, size_t to) {
+				for( size_t r = from; r < to; ++r ) {
+					const RowSpan &span = tableData[base.empty() ? r : base[r]];
+					uint16_t code = slot >= 0 ? rowCodes(span)[slot] : ESCAPE_CODE;
+					if( slot >= 0 ) {
+						keys.ranks[r] = code != ESCAPE_CODE ? valueRanks[code] : NO_RANK;
+					}
+					if( code != ESCAPE_CODE ) {
+						keys.texts[r] = ignoreCase ? keys.foldedValues[code] : dictionaries[slot].values[code];
+					} else if( ignoreCase ) {
+						keys.folded[r] = sortText(sortType, getColumn(span, physical));
+						keys.texts[r] = keys.folded[r];
+					} else {
+						keys.texts[r] = getColumn(span, physical);
+					}
+					if( k == 0 ) {
+						uint64_t prefix = keyPrefix(keys.texts[r]);
+						items[r] = { keys.ascending ? prefix : ~prefix, r };
+					}
+				}
+			});
+			if( k == 0 && slot >= 0 && std::find(keys.ranks.begin(), keys.ranks.end(), NO_RANK) == keys.ranks.end() ) {
+				// all cells are encoded: the rank decides
+				for( SortItem &item : items ) {
+					item.key = keys.ascending ? keys.ranks[item.row] : ~(uint64_t) keys.ranks[item.row];
+				}
+			}
 		}
-		++counter;
-		switch( sortType ) {
-			case 0:		// NUMERIC
-				// TODO make this optional
-				// std::replace( s1.begin(), s1.end(), ',', '.');
-				// std::replace( s2.begin(), s2.end(), ',', '.');
-				try {
-					d1 = std::stod(s1);
-				} catch(const std::exception&) {
-					d1 = 0;
+		Fl::check();
+	}
+
+	auto less = [&columnKeys](const SortItem &lhs, const SortItem &rhs) {
+		if( lhs.key != rhs.key ) {
+			return lhs.key < rhs.key;
+		}
+		for( size_t k = 0; k < columnKeys.size(); ++k ) {
+			const ColumnKeys &keys = columnKeys[k];
+			if( keys.numeric ) {
+				if( k > 0 && keys.numbers[lhs.row] != keys.numbers[rhs.row] ) {
+					return keys.numbers[lhs.row] < keys.numbers[rhs.row];
 				}
-				try {
-					d2 = std::stod(s2);
-				} catch(const std::exception&) {
-					d2 = 0;
+			} else if( !keys.ranks.empty() && keys.ranks[lhs.row] != NO_RANK && keys.ranks[rhs.row] != NO_RANK ) {
+				if( keys.ranks[lhs.row] != keys.ranks[rhs.row] ) {
+					return keys.ascending ? keys.ranks[lhs.row] < keys.ranks[rhs.row] : keys.ranks[lhs.row] > keys.ranks[rhs.row];
 				}
-				if( ascending ) {
-					return d1 < d2;
-				} else {
-					return d1 > d2;
+			} else {
+				int cmp = keys.texts[lhs.row].compare(keys.texts[rhs.row]);
+				if( cmp != 0 ) {
+					return keys.ascending ? cmp < 0 : cmp > 0;
 				}
-			break;
-			case 1:		// STRING with case
-				if( ascending )
-					return s1 < s2;
-				else
-					return s1 > s2;
-			break;
-			case 2:		// STRING ignore case
-				lowerS1 = Utf8CppUtils::utf8::casefold(s1);
-				lowerS2 = Utf8CppUtils::utf8::casefold(s2);
-				if( ascending )
-					return lowerS1 < lowerS2;
-				else
-					return lowerS1 > lowerS2;
-			break;
-			default:
-				return true;
+			}
 		}
-	});
+		return lhs.row < rhs.row;
+	};
+	bool radix = backend == SortBackend::RADIX || (backend == SortBackend::AUTO && numRows >= TCRUNCHER_RADIX_SORT_MIN_ROWS);
+	if( radix && columnKeys.size() == 1 && columnKeys[0].numeric ) {
+		RadixSort::lsd(items, [](const SortItem &item) { return item.key; });		// stable, so equal keys stay in row order
+	} else if( radix ) {
+		RadixSort::msd(items, [](const SortItem &item) { return item.key; }, less);
+	} else {
+		Helper::parallelSort(items, TCRUNCHER_PARALLEL_MIN_ROWS, less);
+	}
+
+	std::vector<table_index_t> order;
+	order.reserve(numRows);
+	for( const SortItem &item : items ) {
+		order.push_back( base.empty() ? item.row : base[item.row] );
+	}
+	return order;
+}
+
+
+/**
+	reorder(std::vector<long> order)
+
+	Puts the rows into the given order: row i becomes the former row order[i]. `order` has to be a
+	permutation of all rows.
+ */
+void CsvDataStorage::reorder(const std::vector<table_index_t> &order) {
+	std::vector<RowSpan> spans;
+	spans.reserve(order.size());
+	for( table_index_t R : order ) {
+		spans.push_back( tableData[R] );
+	}
+	tableData.assign(spans);
+	rowsChanged();
+}
+
+
+/**
+	sortedOrderExternal(std::vector<SortColumn> sortColumns, std::vector<long> base)
+
+	External merge sort for tables whose sort keys don't fit into the memory budget. The rows are sorted in
+	chunks: the keys of a chunk are encoded by encodeSortKey(), sorted and written to a temporary file as a
+	sorted run. The runs are merged then, giving the new row order. Only the keys of a single chunk and a
+	read buffer per run are in memory at the same time.
+	The resulting order is the same as the one of sortedOrder() in memory. Returns an empty vector if the
+	temporary files can't be created, written or read.
+ */
+std::vector<table_index_t> CsvDataStorage::sortedOrderExternal(const std::vector<SortColumn> &sortColumns, const std::vector<table_index_t> &base) {
+	size_t numRows = tableData.size();
+	size_t chunkRows = std::max( TCRUNCHER_EXTERNAL_SORT_MIN_CHUNK_ROWS, (size_t) (sortMemoryBudget() / std::max((int64_t) 1, sortKeyBytes(sortColumns))) );
+
+	// what encodeSortKey() needs to know about every sort column
+	std::vector<SortKeyColumn> keyColumns;
+	for( const SortColumn &sortColumn : sortColumns ) {
+		SortKeyColumn keyColumn;
+		keyColumn.sortColumn = sortColumn;
+		keyColumn.physical = columnMap[sortColumn.column];
+		keyColumn.slot = slotOf(keyColumn.physical);
+		if( sortColumn.sortType == 0 ) {
+			keyColumn.numbers = &numbers(sortColumn.column);
+			keyColumn.integers = keyColumn.numbers->allIntegers();
+		} else if( keyColumn.slot >= 0 ) {
+			for( const std::string &value : dictionaries[keyColumn.slot].values ) {
+				keyColumn.values.push_back( sortColumn.sortType >= 2 ? sortText(sortColumn.sortType, value) : value );
+			}
+		}
+		keyColumns.push_back( std::move(keyColumn) );
+	}
+
+	// write the sorted runs
+	std::vector<std::FILE *> runs;
+	auto closeRuns = [&runs]() {
+		for( std::FILE *run : runs ) {
+			std::fclose(run);
+		}
+	};
+	for( size_t first = 0; first < numRows; first += chunkRows ) {
+		size_t count = std::min(chunkRows, numRows - first);
+		std::vector<std::string> keys(count);
+		Helper::parallelFor(count, TCRUNCHER_PARALLEL_MIN_ROWS, [&](size_t, size_t from, size_t to) {
+			for( size_t i = from; i < to; ++i ) {
+				keys[i] = encodeSortKey(keyColumns, base.empty() ? first + i : base[first + i], first + i);
+			}
+		});
+		Helper::parallelSort(keys, TCRUNCHER_PARALLEL_MIN_ROWS, std::less<std::string>());
+		std::FILE *run = std::tmpfile();
+		if( !run ) {
+			closeRuns();
+			return {};
+		}
+		runs.push_back(run);
+		for( const std::string &key : keys ) {
+			uint32_t length = (uint32_t) key.size();
+			if( std::fwrite(&length, sizeof(length), 1, run) != 1 || std::fwrite(key.data(), 1, length, run) != length ) {
+				closeRuns();
+				return {};
+			}
+		}
+		if( std::fflush(run) != 0 ) {
+			closeRuns();
+			return {};
+		}
+		Fl::check();
+	}
+
+	// k-way merge: a heap holds the run with the smallest current key on top
+	std::vector<std::string> current(runs.size());
+	auto readKey = [&](size_t r) {
+		uint32_t length;
+		if( std::fread(&length, sizeof(length), 1, runs[r]) != 1 ) {
+			return false;
+		}
+		current[r].resize(length);
+		return std::fread(&current[r][0], 1, length, runs[r]) == length;
+	};
+	auto greater = [&current](size_t a, size_t b) {
+		return current[a] > current[b];
+	};
+	std::vector<size_t> heap;
+	for( size_t r = 0; r < runs.size(); ++r ) {
+		std::rewind(runs[r]);
+		if( !readKey(r) ) {
+			closeRuns();
+			return {};
+		}
+		heap.push_back(r);
+	}
+	std::make_heap(heap.begin(), heap.end(), greater);
+	std::vector<table_index_t> order;
+	order.reserve(numRows);
+	while( !heap.empty() ) {
+		std::pop_heap(heap.begin(), heap.end(), greater);
+		size_t r = heap.back();
+		heap.pop_back();
+		// the position is stored big-endian in the last 8 bytes of the key
+		uint64_t position = 0;
+		for( size_t i = current[r].size() - 8; i < current[r].size(); ++i ) {
+			position = (position << 8) | static_cast<unsigned char>(current[r][i]);
+		}
+		order.push_back( base.empty() ? position : base[position] );
+		if( order.size() % TCRUNCHER_PARALLEL_MIN_ROWS == 0 ) {
+			Fl::check();
+		}
+		if( readKey(r) ) {
+			heap.push_back(r);
+			std::push_heap(heap.begin(), heap.end(), greater);
+		} else if( !std::feof(runs[r]) ) {
+			closeRuns();
+			return {};
+		}
+	}
+	closeRuns();
+	if( order.size() != numRows ) {
+		return {};
+	}
+	return order;
+}
+
+
+/**
+	encodeSortKey(std::vector<SortKeyColumn> keyColumns, size_t R, size_t position)
+
+	Encodes the sort keys of row R into a string, so that comparing two of them byte by byte gives the order
+	of the rows (just like the in-memory sort): numbers as their order-preserving key (big-endian), strings with
+	every 0 byte escaped as 0x00 0xFF and terminated by 0x00 0x00, so shorter strings come first. Keys of
+	descending columns are inverted. The position of the row ends the key, it keeps equal rows in their order.
+ */
+std::string CsvDataStorage::encodeSortKey(const std::vector<SortKeyColumn> &keyColumns, size_t R, size_t position) const {
+	std::string encoded;
+	auto appendInteger = [&encoded](uint64_t value) {
+		for( int shift = 56; shift >= 0; shift -= 8 ) {
+			encoded.push_back( (char) ((value >> shift) & 0xFF) );
+		}
+	};
+	for( const SortKeyColumn &keyColumn : keyColumns ) {
+		size_t start = encoded.size();
+		if( keyColumn.numbers ) {
+			appendInteger( keyColumn.integers ? RadixSort::orderedKey(keyColumn.numbers->integerAt(R)) : RadixSort::orderedKey(keyColumn.numbers->realAt(R)) );
+		} else {
+			uint16_t code = keyColumn.slot >= 0 ? rowCodes(tableData[R])[keyColumn.slot] : ESCAPE_CODE;
+			std::string folded;
+			std::string_view text;
+			if( code != ESCAPE_CODE ) {
+				text = keyColumn.values[code];
+			} else if( keyColumn.sortColumn.sortType >= 2 ) {
+				folded = sortText(keyColumn.sortColumn.sortType, getColumn(tableData[R], keyColumn.physical));
+				text = folded;
+			} else {
+				text = getColumn(tableData[R], keyColumn.physical);
+			}
+			for( char c : text ) {
+				encoded.push_back(c);
+				if( c == '\0' ) {
+					encoded.push_back( (char) 0xFF );
+				}
+			}
+			encoded.append(2, '\0');
+		}
+		if( !keyColumn.sortColumn.ascending ) {
+			for( size_t i = start; i < encoded.size(); ++i ) {
+				encoded[i] = ~encoded[i];
+			}
+		}
+	}
+	appendInteger(position);
+	return encoded;
+}
+
+
+/**
+	sortKeyBytes(std::vector<SortColumn> sortColumns)
+
+	Estimates the memory needed per row for sorting by the given columns: the keys, the copy of the row order
+	and for numeric columns the parsed numbers
+ */
+int64_t CsvDataStorage::sortKeyBytes(const std::vector<SortColumn> &sortColumns) {
+	int64_t cellBytes = 0;
+	if( rows() > 0 && physicalColumns > 0 ) {
+		cellBytes = liveBytes / (rows() * physicalColumns);
+	}
+	int64_t bytes = 16 + sizeof(RowSpan);
+	for( const SortColumn &sortColumn : sortColumns ) {
+		if( sortColumn.sortType == 0 ) {
+			bytes += cachedNumbers(sortColumn.column) ? 8 : 16;
+		} else {
+			bytes += sizeof(std::string_view);
+			if( sortColumn.sortType == 2 ) {
+				bytes += sizeof(std::string) + cellBytes;
+			} else if( sortColumn.sortType == 3 ) {
+				bytes += sizeof(std::string) + 2 * cellBytes + 1;
+			}
+		}
+	}
+	return bytes;
+}
+
 
+/**
+	sortWorkingSet(std::vector<SortColumn> sortColumns)
+
+	Estimates the memory needed for sorting the table in memory
+ */
+int64_t CsvDataStorage::sortWorkingSet(const std::vector<SortColumn> &sortColumns) {
+	return rows() * sortKeyBytes(sortColumns);
+}
+
+
+/**
+	sortMemoryBudget()
+
+	Returns the memory sort() may use: the limit set by setSortMemoryLimit() or a fraction of the physical memory
+ */
+int64_t CsvDataStorage::sortMemoryBudget() {
+	if( sortMemoryLimit > 0 ) {
+		return sortMemoryLimit;
+	}
+	int64_t physical = Helper::getPhysMemSize();
+	if( physical <= 0 ) {
+		return INT64_MAX;
+	}
+	return (int64_t) (physical * TCRUNCHER_SORT_MEMORY_FRACTION);
+}
+
+
+/**
+	setSortMemoryLimit(int64_t bytes)
+
+	Sets the memory sort() may use, above that it sorts using temporary files. 0 uses a fraction of the
+	physical memory.
+ */
+void CsvDataStorage::setSortMemoryLimit(int64_t bytes) {
+	sortMemoryLimit = bytes;
+}
+
+
+/**
+	sortText(int sortType, std::string_view s)
+
+	Returns the text that is compared instead of `s` for sort type 2 (ignore case: casefolded) and
+	3 (natural: Helper::collationKey())
+ */
+std::string CsvDataStorage::sortText(int sortType, std::string_view s) {
+	if( sortType == 3 ) {
+		return Helper::collationKey(s);
+	}
+	return Utf8CppUtils::utf8::casefold( std::string(s) );
+}
+
+
+/**
+	keyPrefix(std::string_view s)
 
+	Returns the first 8 bytes of `s` as a big-endian integer (padded with 0), so comparing two prefixes gives
+	the same result as comparing the first 8 bytes of the strings
+ */
+uint64_t CsvDataStorage::keyPrefix(std::string_view s) {
+	uint64_t prefix = 0;
+	for( size_t i = 0; i < 8; ++i ) {
+		prefix = (prefix << 8) | (i < s.size() ? static_cast<unsigned char>(s[i]) : 0);
+	}
+	return prefix;
 }
 
 
@@ -187,7 +682,37 @@ void CsvDataStorage::sort(table_index_t column, bool ascending, int sortType) {
 std::string CsvDataStorage::get(table_index_t R, table_index_t C) {
 	if( C < 0 || R < 0 || R >= rows() || C >= columns() )
 		return "";
-	return getColumn(tableData.at(R), C);
+	return std::string(getColumn(tableData.at(R), columnMap[C]));
+}
+
+
+
+/**
+	getView(long R, long C)
+
+	Like get(), but returns a view into the storage instead of a copy.
+	The view gets invalid as soon as the storage is modified.
+ */
+std::string_view CsvDataStorage::getView(table_index_t R, table_index_t C) const {
+	if( C < 0 || R < 0 || R >= (table_index_t) tableData.size() || C >= (table_index_t) columnMap.size() )
+		return std::string_view();
+	return getColumn(tableData[R], columnMap[C]);
+}
+
+
+
+/**
+	rowView(long R)
+
+	Like getRow(), but returns a view into the storage instead of a copy. The fields of dictionary-encoded
+	columns are empty in this view, unless their value didn't fit into the dictionary.
+	The view gets invalid as soon as the storage is modified.
+ */
+std::string_view CsvDataStorage::rowView(table_index_t R) const {
+	if( R < 0 || R >= (table_index_t) tableData.size() )
+		return std::string_view();
+	const RowSpan &span = tableData[R];
+	return std::string_view(rowData(span), span.length);
 }
 
 
@@ -200,7 +725,7 @@ std::string CsvDataStorage::get(table_index_t R, table_index_t C) {
 std::string CsvDataStorage::getRow(table_index_t R) {
 	if( R < 0 || R >= rows() )
 		return "";
-	return tableData.at(R);
+	return decodedRowString(tableData.at(R));
 }
 
 
@@ -213,7 +738,14 @@ std::string CsvDataStorage::getRow(table_index_t R) {
 bool CsvDataStorage::set(std::string content, table_index_t R, table_index_t C) {
 	if( C < 0 || R < 0 || R >= rows() || C >= columns() )
 		return false;
-	tableData.at(R) = setColumn(tableData.at(R), C, content);
+	setColumn(R, columnMap[C], content);
+	auto cached = numericColumns.find(columnMap[C]);
+	if( cached != numericColumns.end() ) {
+		if( cached->second.use_count() > 1 ) {
+			cached->second = std::make_shared<NumericColumn>(*cached->second);		// shared with a copy of the storage
+		}
+		cached->second->update(R, content);
+	}
 	return true;
 }
 
@@ -246,17 +778,29 @@ std::vector<std::string> CsvDataStorage::row(table_index_t R) {
 	rawRow(long R)
 
 	Return a single row as a vector-of-string, no matter how tableData is implemented.
-	The size of the returned vector is determined by the number of actual columns.
+	The size of the returned vector is determined by the number of actual columns: if the columns have been
+	rearranged, it ends with the last logical column the row contains.
 
 	@return		vector
  */
 std::vector<std::string> CsvDataStorage::rawRow(table_index_t R) {
 	std::vector<std::string> row;
 	if( R >= 0 && R < rows() ) {
-		return splitString(tableData.at(R));
-	} else {
-		return row;
+		if( columnsInOrder ) {
+			return splitString(getRow(R));
+		}
+		table_index_t fields = (table_index_t) tableData.at(R).delimiters + 1;
+		table_index_t length = 1;
+		for( table_index_t c = 0; c < columns(); ++c ) {
+			if( columnMap[c] < fields ) {
+				length = c + 1;
+			}
+		}
+		for( table_index_t c = 0; c < length; ++c ) {
+			row.push_back( get(R,c) );
+		}
 	}
+	return row;
 }
 
 
@@ -266,11 +810,27 @@ std::vector<std::string> CsvDataStorage::rawRow(table_index_t R) {
 	Adds row to the end of the table data
  */
 void CsvDataStorage::push_back(std::string rowString) {
-	tableData.push_back(rowString);
+	if( columnsInOrder ) {
+		tableData.push_back(storeRow(rowString));
+	} else {
+		tableData.push_back(storeRow(physicalRowString(splitString(rowString))));
+	}
+	rowsChanged();
 }
 
 void CsvDataStorage::push_back(std::vector<std::string> row) {
-	tableData.push_back(mergeString(row));
+	tableData.push_back(storeRow(physicalRowString(row)));
+	rowsChanged();
+}
+
+void CsvDataStorage::push_back(const RowBuffer &row) {
+	if( columnsInOrder && dictionaries.empty() ) {
+		// the buffer already is a record: copy it right into the slabs
+		tableData.push_back(storeRow(row.data.data(), row.data.size(), row.delimiters.data(), row.delimiters.size(), nullptr));
+		rowsChanged();
+	} else {
+		push_back(row.data);
+	}
 }
 
 
@@ -281,11 +841,17 @@ void CsvDataStorage::push_back(std::vector<std::string> row) {
  */
 void CsvDataStorage::push_front(std::string row) {
 		// TODO edit length histogram!?
-	tableData.insert(tableData.begin(), row);
+	if( columnsInOrder ) {
+		tableData.insert(0, storeRow(row));
+	} else {
+		tableData.insert(0, storeRow(physicalRowString(splitString(row))));
+	}
+	rowsChanged();
 }
 void CsvDataStorage::push_front(std::vector<std::string> row) {
 		// TODO edit length histogram!?
-	tableData.insert(tableData.begin(), mergeString(row));
+	tableData.insert(0, storeRow(physicalRowString(row)));
+	rowsChanged();
 }
 
 /**
@@ -295,26 +861,54 @@ void CsvDataStorage::push_front(std::vector<std::string> row) {
  */
 void CsvDataStorage::deleteRows(table_index_t rowFrom, table_index_t rowTo) {
 	if( rowFrom >= 0 && rowFrom < rows() && rowTo >= rowFrom && rowTo < rows() ) {
-		tableData.erase( tableData.begin() + rowFrom, tableData.begin() + rowTo + 1 );
+		for( table_index_t r = rowFrom; r <= rowTo; ++r ) {
+			releaseRow(tableData.at(r));
+		}
+		tableData.erase(rowFrom, rowTo + 1);
+		rowsChanged();
+		compact();
 	}
 }
 
 
 
+/**
+	deleteRowsIf(const std::function<bool(long)> &predicate)
+
+	Delete all rows R for which predicate(R) is true – R being the row number before deleting – in a single
+	pass that keeps the order of the remaining rows. Returns the number of deleted rows.
+ */
+table_index_t CsvDataStorage::deleteRowsIf(const std::function<bool(table_index_t)> &predicate) {
+	table_index_t deleted = 0;
+	tableData.eraseIf([&](size_t r, const RowSpan &span) {
+		if( predicate((table_index_t) r) ) {
+			releaseRow(span);
+			++deleted;
+			return true;
+		}
+		return false;
+	});
+	rowsChanged();
+	compact();
+	return deleted;
+}
+
+
+
 /**
 	deleteColumns(long colFrom, long colTo)
 
-	Deletes multiple columns.
+	Deletes multiple columns. Only `columnMap` is changed, the rows are rewritten when the fields of
+	deleted columns outweigh the live ones.
  */
 void CsvDataStorage::deleteColumns(table_index_t colFrom, table_index_t colTo) {
-	table_index_t R = rows();
 	if( colFrom >= 0 && colFrom < columns() && colTo >= colFrom && colTo < columns() ) {
-		for( table_index_t r = 0; r < R; ++r ) {
-			std::vector<std::string> row = splitString(tableData.at(r));
-			row.erase( row.begin() + colFrom, row.begin() + colTo + 1);
-			tableData.at(r) = mergeString(row);
+		columnMap.erase( columnMap.begin() + colFrom, columnMap.begin() + colTo + 1 );
+		if( physicalColumns - columns() > columns() ) {
+			materializeColumns();
+		} else {
+			updateColumnsInOrder();
 		}
-		numColumns -= colTo - colFrom + 1;
 	}
 }
 
@@ -326,16 +920,34 @@ void CsvDataStorage::deleteColumns(table_index_t colFrom, table_index_t colTo) {
  */
 
 void CsvDataStorage::insertRow(table_index_t R, table_index_t before) {
-	std::vector<std::string>::iterator it;
-	std::string newRow = emptyCellsString(columns() - 1);
 	if( R >= 0 && R < rows() ) {
+		RowSpan newRow = storeRow(std::string());
 		// insert new row
-		it = tableData.begin();
 		if( before ) {
-			tableData.insert(it + R, newRow);
+			tableData.insert(R, newRow);
 		} else {
-			tableData.insert(it + R + 1, newRow);
+			tableData.insert(R + 1, newRow);
+		}
+		rowsChanged();
+	}
+}
+
+
+
+/**
+	insertRows(long R, std::vector<std::vector<std::string>> rows)
+
+	Inserts `rows` (in logical column order) before row `R`, or appends them if R is rows().
+ */
+void CsvDataStorage::insertRows(table_index_t R, const std::vector< std::vector<std::string> > &rows) {
+	if( R >= 0 && R <= this->rows() ) {
+		std::vector<RowSpan> spans;
+		spans.reserve(rows.size());
+		for( const std::vector<std::string> &row : rows ) {
+			spans.push_back( storeRow(physicalRowString(row)) );
 		}
+		tableData.insert(R, spans);
+		rowsChanged();
 	}
 }
 
@@ -345,21 +957,12 @@ void CsvDataStorage::insertRow(table_index_t R, table_index_t before) {
 	insertColumn(long C, bool before=false)
 
 	Insert a column after column `C`, or before if `before` is true.
-	// a simple solution based on tableData.at(i).insert() throws std::bad_alloc execptions,
-	// if the container is big (e.g. 500000 lines) – not the case anymore??
+	The new column is a physical column no row contains yet, so no row has to be touched.
  */
 void CsvDataStorage::insertColumn(table_index_t C, bool before) {
-	table_index_t R = rows();
 	if( C >= 0 && C < columns() ) {
-		for( table_index_t r = 0; r < R; ++r ) {
-			std::vector<std::string> row = splitString(tableData.at(r));
-			if( before )
-				row.insert(row.begin() + C, "");
-			else
-				row.insert(row.begin() + C + 1, "");
-			tableData.at(r) = mergeString(row);
-		}
-		++numColumns;
+		columnMap.insert( columnMap.begin() + (before ? C : C + 1), physicalColumns++ );
+		updateColumnsInOrder();
 	}
 }
 
@@ -368,39 +971,22 @@ void CsvDataStorage::insertColumn(table_index_t C, bool before) {
 /**
 	moveColumns(long colFrom, long colTo, bool right)
 
-	Move columns.
+	Move columns by one to the right or left. Only `columnMap` is changed.
 
 	  0   1   2   3   4
 	| A | B | C | D | E |
  */
 void CsvDataStorage::moveColumns(table_index_t colFrom, table_index_t colTo, bool right) {
-	table_index_t R = rows();
 	table_index_t C = columns();
-	std::string buffer = "";
-	
 	if( right ) {
 		if( colTo < C - 1 && colFrom >= 0 ) {
-			for( table_index_t r = 0; r < R; ++r ) {
-				std::vector<std::string> row = splitString(tableData.at(r));
-				buffer = row.at(colTo + 1);
-				for( int c = colTo; c >= colFrom; --c ) {
-					row.at(c + 1) = row.at(c);
-				}
-				row.at(colFrom) = buffer;
-				tableData.at(r) = mergeString(row);
-			}
+			std::rotate( columnMap.begin() + colFrom, columnMap.begin() + colTo + 1, columnMap.begin() + colTo + 2 );
+			updateColumnsInOrder();
 		}
 	} else {
 		if( colFrom > 0 && colTo < C ) {
-			for( table_index_t r = 0; r < R; ++r ) {
-				std::vector<std::string> row = splitString(tableData.at(r));
-				buffer = row.at(colFrom - 1);
-				for( int c = colFrom; c <= colTo; ++c ) {
-					row.at(c - 1) = row.at(c);
-				}
-				row.at(colTo) = buffer;
-				tableData.at(r) = mergeString(row);
-			}
+			std::rotate( columnMap.begin() + colFrom - 1, columnMap.begin() + colFrom, columnMap.begin() + colTo + 1 );
+			updateColumnsInOrder();
 		}
 	}
 }
@@ -410,35 +996,285 @@ bool CsvDataStorage::cellContainsLineBreak(table_index_t R, table_index_t C) {
 	return get(R,C).find("\n") != std::string::npos;
 }
 
+
 /**
-	splitString()
+	encodeColumns()
 
-	Splits the given string at the defined internal CSV delimiter
+	Samples every column that isn't encoded yet and dictionary-encodes the ones with few distinct values,
+	if their values are longer than a code on average. The columns are examined in parallel, then all rows get
+	rewritten once with the codes of the new dictionaries. Called after a file has been parsed.
  */
-std::vector<std::string> CsvDataStorage::splitString(std::string str) {
-	std::vector<std::string> splitted;
-	std::string tempStr = "";
-	size_t str_size = str.size();
-	for( size_t i = 0; i < str_size; ++i ) {
-		if( static_cast<unsigned char>(str[i]) != CsvDataStorage::TCRUNCHER_UTF_8_DELIMITER ) {
-			tempStr.push_back(str[i]);
-		} else {
-			splitted.push_back(tempStr);
-			tempStr = "";
+void CsvDataStorage::encodeColumns() {
+	size_t R = tableData.size();
+	if( R < TCRUNCHER_ENCODE_MIN_ROWS ) {
+		return;
+	}
+	size_t step = std::max( R / TCRUNCHER_ENCODE_SAMPLE_ROWS, (size_t) 1 );
+	std::vector<Dictionary> candidates;
+	for( table_index_t physical = 0; physical < physicalColumns; ++physical ) {
+		if( slotOf(physical) < 0 ) {
+			candidates.emplace_back(physical);
 		}
 	}
-	splitted.push_back(tempStr);
-	return splitted;
+	std::vector<char> encode(candidates.size(), false);
+
+	Helper::parallelFor(candidates.size(), 1, [&](size_t, size_t from, size_t to) {
+		for( size_t i = from; i < to; ++i ) {
+			Dictionary &dictionary = candidates[i];
+			// estimate the cardinality from a sample
+			size_t sampledRows = 0;
+			size_t sampledBytes = 0;
+			for( size_t r = 0; r < R && dictionary.values.size() <= TCRUNCHER_ENCODE_MAX_SAMPLED_VALUES; r += step ) {
+				std::string_view value = getColumn(tableData[r], dictionary.column);
+				dictionary.encode(value);
+				sampledBytes += value.size();
+				++sampledRows;
+			}
+			// a code takes 2 bytes, shorter values don't gain anything
+			if( dictionary.values.size() > TCRUNCHER_ENCODE_MAX_SAMPLED_VALUES || sampledBytes <= 2 * sampledRows ) {
+				continue;
+			}
+			// values that don't fit into the dictionary anymore are escaped by encodeRow()
+			for( const RowSpan &span : tableData ) {
+				dictionary.encode(getColumn(span, dictionary.column));
+			}
+			encode[i] = true;
+		}
+	});
+
+	size_t firstNewSlot = dictionaries.size();
+	for( size_t i = 0; i < candidates.size(); ++i ) {
+		if( encode[i] ) {
+			table_index_t physical = candidates[i].column;
+			if( physical >= (table_index_t) columnSlots.size() ) {
+				columnSlots.resize(physical + 1, -1);
+			}
+			columnSlots[physical] = (int32_t) dictionaries.size();
+			dictionaries.push_back( std::move(candidates[i]) );
+		}
+	}
+	if( dictionaries.size() > firstNewSlot ) {
+		rewriteRows(dictionaries.size(), [&](const RowSpan &span, SlabList &target) {
+			return encodeRow(span, firstNewSlot, target);
+		});
+	}
+}
+
+
+bool CsvDataStorage::hasEncodedColumns() const {
+	return !dictionaries.empty();
+}
+
+
+bool CsvDataStorage::isEncodedColumn(table_index_t C) const {
+	return C >= 0 && C < (table_index_t) columnMap.size() && slotOf(columnMap[C]) >= 0;
 }
 
 
 /**
-	mergeVector()
+	dictionary(long C)
 
-	Merges the given vector-of-strings with the defined internal CSV delimiter
-*/
-std::string CsvDataStorage::mergeString(std::vector<std::string> row) {
-	std::string merged = "";
+	Returns the distinct values of the encoded column C, the index of a value is its code. Tasks like sorting,
+	grouping or filtering can handle every distinct value once and look up the rows by getCode() then.
+	Returns an empty vector, if C isn't encoded.
+ */
+const std::vector<std::string> &CsvDataStorage::dictionary(table_index_t C) const {
+	static const std::vector<std::string> none;
+	if( !isEncodedColumn(C) ) {
+		return none;
+	}
+	return dictionaries[slotOf(columnMap[C])].values;
+}
+
+
+/**
+	getCode(long R, long C)
+
+	Returns the code of cell R,C within dictionary(C), or -1 if C isn't encoded or the value of this cell
+	is stored in the row string because the dictionary was full. Use getView() in that case.
+ */
+int32_t CsvDataStorage::getCode(table_index_t R, table_index_t C) const {
+	if( R < 0 || R >= (table_index_t) tableData.size() || !isEncodedColumn(C) ) {
+		return -1;
+	}
+	uint16_t code = rowCodes(tableData[R])[slotOf(columnMap[C])];
+	return code != ESCAPE_CODE ? code : -1;
+}
+
+
+/**
+	numbers(long C)
+
+	Returns the cells of column C parsed as numbers. The column is parsed in parallel on the first call and
+	kept until the rows change, set() keeps it up to date. Returns an empty NumericColumn for invalid columns.
+	The reference gets invalid with the next modification of the rows.
+ */
+const NumericColumn &CsvDataStorage::numbers(table_index_t C) {
+	static const NumericColumn none(0, 1, [](size_t) { return std::string_view(); });
+	if( C < 0 || C >= columns() ) {
+		return none;
+	}
+	table_index_t physical = columnMap[C];
+	auto cached = numericColumns.find(physical);
+	if( cached == numericColumns.end() ) {
+		cached = numericColumns.emplace(physical, std::make_shared<NumericColumn>(tableData.size(), TCRUNCHER_PARALLEL_MIN_ROWS, [this, physical](size_t R) {
+			return getColumn(tableData[R], physical);
+		})).first;
+	}
+	return *cached->second;
+}
+
+
+const NumericColumn *CsvDataStorage::cachedNumbers(table_index_t C) const {
+	if( C < 0 || C >= (table_index_t) columnMap.size() ) {
+		return nullptr;
+	}
+	auto cached = numericColumns.find(columnMap[C]);
+	return cached != numericColumns.end() ? cached->second.get() : nullptr;
+}
+
+/**
+	splitString()
+
+	Splits the given string at the defined internal CSV delimiter
+ */
+std::vector<std::string> CsvDataStorage::splitString(std::string str) {
+	std::vector<std::string> splitted;
+	std::string tempStr = "";
+	size_t str_size = str.size();
+	for( size_t i = 0; i < str_size; ++i ) {
+		if( static_cast<unsigned char>(str[i]) != CsvDataStorage::TCRUNCHER_UTF_8_DELIMITER ) {
+			tempStr.push_back(str[i]);
+		} else {
+			splitted.push_back(tempStr);
+			tempStr = "";
+		}
+	}
+	splitted.push_back(tempStr);
+	return splitted;
+}
+
+
+/**
+	append(Segment &segment, size_t from)
+
+	Appends the rows of `segment` from row `from` on to the end of the table. If the columns are in order and not
+	encoded, the slabs of the segment are taken over as they are, otherwise every row is stored anew.
+ */
+void CsvDataStorage::append(Segment &segment, size_t from) {
+	if( columnsInOrder && dictionaries.empty() ) {
+		uint32_t slabOffset = (uint32_t) slabs.size();
+		for( size_t r = 0; r < segment.spans.size(); ++r ) {
+			RowSpan span = segment.spans[r];
+			if( r < from ) {
+				deadBytes += recordSize(span);
+				continue;
+			}
+			span.slab += slabOffset;
+			liveBytes += recordSize(span);
+			tableData.push_back(span);
+		}
+		for( std::shared_ptr<Slab> &slab : segment.slabs ) {
+			slabs.push_back( std::move(slab) );
+		}
+	} else {
+		for( size_t r = from; r < segment.spans.size(); ++r ) {
+			const RowSpan &span = segment.spans[r];
+			std::string rowString(segment.slabs[span.slab]->bytes() + span.offset + span.delimiters * sizeof(uint32_t), span.length);
+			tableData.push_back(storeRow(columnsInOrder ? rowString : physicalRowString(splitString(rowString))));
+		}
+	}
+	segment.slabs.clear();
+	segment.spans.clear();
+	rowsChanged();
+}
+
+
+/**
+	moveRowsTo(Segment &segment)
+
+	Moves all rows to the end of `segment` and leaves the storage without rows, but with its columns. The slabs are
+	handed over as they are if the columns are in order and not encoded – like in a storage only the parser has
+	filled. Otherwise every row gets copied in logical column order.
+ */
+void CsvDataStorage::moveRowsTo(Segment &segment) {
+	if( columnsInOrder && dictionaries.empty() ) {
+		uint32_t slabOffset = (uint32_t) segment.slabs.size();
+		segment.spans.reserve(segment.spans.size() + tableData.size());
+		for( RowSpan span : tableData ) {
+			span.slab += slabOffset;
+			segment.spans.push_back(span);
+		}
+		for( std::shared_ptr<Slab> &slab : slabs ) {
+			segment.slabs.push_back( std::move(slab) );
+		}
+	} else {
+		RowBuffer buffer;
+		for( table_index_t r = 0; r < rows(); ++r ) {
+			buffer.clear();
+			std::vector<std::string> fields = row(r);
+			for( size_t c = 0; c < fields.size(); ++c ) {
+				if( c > 0 ) {
+					buffer.endField();
+				}
+				buffer.data.append(fields[c]);
+			}
+			segment.push_back(buffer);
+		}
+	}
+	tableData.clear();
+	slabs.clear();
+	liveBytes = 0;
+	deadBytes = 0;
+	rowsChanged();
+}
+
+
+/**
+	Segment::push_back(const RowBuffer &row)
+
+	Appends the record of `row` to the last slab of the segment
+ */
+void CsvDataStorage::Segment::push_back(const RowBuffer &row) {
+	spans.push_back( writeRecord(slabs, row.data.data(), row.data.size(), row.delimiters.data(), row.delimiters.size(), nullptr, 0) );
+}
+
+
+size_t CsvDataStorage::Segment::size() const {
+	return spans.size();
+}
+
+
+size_t CsvDataStorage::Segment::fields(size_t i) const {
+	return spans[i].delimiters + 1;
+}
+
+
+/**
+	Segment::shrink()
+
+	Copies the records of the last slab into one of exactly their size, so a segment of few rows doesn't keep a
+	whole slab alive.
+ */
+void CsvDataStorage::Segment::shrink() {
+	if( slabs.empty() || slabs.back()->used == slabs.back()->capacity ) {
+		return;
+	}
+	std::shared_ptr<Slab> fitting = std::make_shared<Slab>( slabs.back()->used );
+	memcpy(fitting->bytes(), slabs.back()->bytes(), slabs.back()->used);
+	fitting->used = slabs.back()->used;
+	slabs.back() = fitting;
+}
+
+
+
+/**
+	mergeVector()
+
+	Merges the given vector-of-strings with the defined internal CSV delimiter
+*/
+std::string CsvDataStorage::mergeString(std::vector<std::string> row) {
+	std::string merged = "";
 	for(size_t i = 0; i < row.size(); ++i ) {
 		if( i > 0 )
 			merged.push_back( static_cast<char>(CsvDataStorage::TCRUNCHER_UTF_8_DELIMITER) );
@@ -450,59 +1286,568 @@ std::string CsvDataStorage::mergeString(std::vector<std::string> row) {
 
 
 /**
-	getColumn(std::string row, long column)
+	storeRow(const std::string &rowString)
 
-	a#bcd#ef#hij
-    0123456789ab
+	Records the position of every delimiter in rowString and copies the record into the slabs.
+	The fields of encoded columns are replaced by their codes.
  */
-std::string CsvDataStorage::getColumn(std::string rowString, table_index_t column) {
-	std::pair<table_index_t,table_index_t> fromTo = getColumnIndizes(rowString, column);
-	if( fromTo.second - fromTo.first - 1 <= (table_index_t) rowString.size() && fromTo.second > fromTo.first ) {
-		return rowString.substr(fromTo.first + 1, (fromTo.second - fromTo.first - 1));
-	} else {
-		return "";
-	}
-}
-
-std::pair<table_index_t,table_index_t> CsvDataStorage::getColumnIndizes(std::string rowString, table_index_t column) {
-	bool colFound = false;
+CsvDataStorage::RowSpan CsvDataStorage::storeRow(const std::string &rowString) {
+	std::vector<uint32_t> delimiters;
 	size_t str_size = rowString.size();
-	table_index_t fromIdx = -1;
-	table_index_t toIdx = -1;
-	table_index_t colCounter = 0;
 	for( size_t i = 0; i < str_size; ++i ) {
 		if( static_cast<unsigned char>(rowString[i]) == CsvDataStorage::TCRUNCHER_UTF_8_DELIMITER ) {
-			if( colCounter == column ) {
-				toIdx = i;
-				colFound = true;
-				break;
+			delimiters.push_back( (uint32_t) i );
+		}
+	}
+	if( dictionaries.empty() ) {
+		return storeRow(rowString.data(), str_size, delimiters.data(), delimiters.size(), nullptr);
+	}
+
+	std::vector<uint16_t> codes(dictionaries.size(), 0);
+	std::string encoded;
+	std::vector<uint32_t> encodedDelimiters;
+	encoded.reserve(str_size);
+	encodedDelimiters.reserve(delimiters.size());
+	for( size_t f = 0; f <= delimiters.size(); ++f ) {
+		size_t start = f == 0 ? 0 : delimiters[f - 1] + 1;
+		size_t end = f < delimiters.size() ? delimiters[f] : str_size;
+		std::string_view field(rowString.data() + start, end - start);
+		if( f > 0 ) {
+			encodedDelimiters.push_back( (uint32_t) encoded.size() );
+			encoded.push_back( static_cast<char>(TCRUNCHER_UTF_8_DELIMITER) );
+		}
+		int32_t slot = slotOf(f);
+		if( slot >= 0 ) {
+			codes[slot] = dictionaries[slot].encode(field);
+			if( codes[slot] != ESCAPE_CODE ) {
+				continue;
 			}
-			++colCounter;
-			fromIdx = i;
 		}
+		encoded.append(field);
 	}
-	if( !colFound ) {
-		if( column == colCounter ) {
-			toIdx = rowString.size();
+	return storeRow(encoded.data(), encoded.size(), encodedDelimiters.data(), encodedDelimiters.size(), codes.data());
+}
+
+
+/**
+	storeRow(const char *data, size_t length, const uint32_t *delimiters, size_t numDelimiters, const uint16_t *codes)
+
+	Appends a record to the last slab. `codes` holds one code per encoded column, nullptr stores code 0 (the empty string) for all.
+ */
+CsvDataStorage::RowSpan CsvDataStorage::storeRow(const char *data, size_t length, const uint32_t *delimiters, size_t numDelimiters, const uint16_t *codes) {
+	RowSpan span = writeRecord(slabs, data, length, delimiters, numDelimiters, codes, numCodes);
+	liveBytes += recordSize(span);
+	return span;
+}
+
+
+/**
+	writeRecord(SlabList &target, const char *data, size_t length, const uint32_t *delimiters, size_t numDelimiters, const uint16_t *codes, size_t numCodes)
+
+	Appends a record with `numCodes` codes to the last slab of target.
+ */
+CsvDataStorage::RowSpan CsvDataStorage::writeRecord(SlabList &target, const char *data, size_t length, const uint32_t *delimiters, size_t numDelimiters, const uint16_t *codes, size_t numCodes) {
+	RowSpan span;
+	span.length = (uint32_t) length;
+	span.delimiters = (uint32_t) numDelimiters;
+	char *dest = reserveRecord(target, span, numCodes);
+	if( numDelimiters ) {
+		memcpy(dest, delimiters, numDelimiters * sizeof(uint32_t));
+	}
+	dest += numDelimiters * sizeof(uint32_t);
+	if( numCodes ) {
+		if( codes ) {
+			memcpy(dest, codes, numCodes * sizeof(uint16_t));
 		} else {
-			toIdx = -1;
+			memset(dest, 0, numCodes * sizeof(uint16_t));
 		}
 	}
-	return std::make_pair(fromIdx, toIdx);
+	if( length ) {
+		memcpy(dest + numCodes * sizeof(uint16_t), data, length);
+	}
+	return span;
+}
+
+
+/**
+	reserveRecord(SlabList &target, RowSpan &span, size_t numCodes)
+
+	Reserves room for a record with `span.length` bytes, `span.delimiters` delimiters and `numCodes` codes at
+	the end of `target` and sets `span.slab` and `span.offset` accordingly. Returns the start of the record.
+	A new slab is started if the record doesn't fit or the last slab is shared with a copy of the storage,
+	records larger than TCRUNCHER_SLAB_SIZE get a slab of their own.
+ */
+char *CsvDataStorage::reserveRecord(SlabList &target, RowSpan &span, size_t numCodes) {
+	size_t size = recordSize(span, numCodes);
+	if( target.empty() || target.back().use_count() > 1 || target.back()->capacity - target.back()->used < size ) {
+		target.push_back( std::make_shared<Slab>( std::max(size, TCRUNCHER_SLAB_SIZE) ) );
+	}
+	Slab &slab = *target.back();
+	span.slab = (uint32_t) (target.size() - 1);
+	span.offset = (uint32_t) slab.used;
+	slab.used += size;
+	return slab.bytes() + span.offset;
+}
+
+
+/**
+	rewriteRows(size_t newNumCodes, const std::function<RowSpan(const RowSpan &, SlabList &)> &rewrite)
+
+	Replaces every row by `rewrite(row, target)`, which writes the new record (with `newNumCodes` codes) into
+	`target`. The rows get split into ranges, each range is handled by a thread of its own that writes into its
+	own slabs. Afterwards these slabs replace the old ones, so this is a compaction as well.
+ */
+void CsvDataStorage::rewriteRows(size_t newNumCodes, const std::function<RowSpan(const RowSpan &, SlabList &)> &rewrite) {
+	std::vector<RowSpan> spans = tableData.toVector();		// every row changes, so all blocks get replaced
+	size_t R = spans.size();
+	size_t numChunks = Helper::parallelChunks(R, TCRUNCHER_PARALLEL_MIN_ROWS);
+	std::vector<SlabList> chunkSlabs(numChunks);
+
+	Helper::parallelFor(R, TCRUNCHER_PARALLEL_MIN_ROWS, [&](size_t chunk, size_t from, size_t to) {
+		for( size_t r = from; r < to; ++r ) {
+			spans[r] = rewrite(spans[r], chunkSlabs[chunk]);
+		}
+	});
+	numCodes = newNumCodes;
+
+	// Put the slabs of all chunks together
+	SlabList newSlabs;
+	liveBytes = 0;
+	deadBytes = 0;
+	for( size_t chunk = 0; chunk < numChunks; ++chunk ) {
+		uint32_t slabOffset = (uint32_t) newSlabs.size();
+		for( size_t r = R * chunk / numChunks; r < R * (chunk + 1) / numChunks; ++r ) {
+			spans[r].slab += slabOffset;
+			liveBytes += recordSize(spans[r]);
+		}
+		for( std::shared_ptr<Slab> &slab : chunkSlabs[chunk] ) {
+			newSlabs.push_back( std::move(slab) );
+		}
+	}
+	slabs.swap(newSlabs);
+	tableData.assign(spans);
+}
+
+
+/**
+	remapColumns(const std::vector<table_index_t> &sourceColumns)
+
+	Rebuilds every row, so that column `c` of the new row is column `sourceColumns[c]` of the old row,
+	or an empty column if `sourceColumns[c]` is -1. Used to insert, delete and move columns.
+	The dictionaries follow their columns, the ones of dropped columns are dropped.
+ */
+void CsvDataStorage::remapColumns(const std::vector<table_index_t> &sourceColumns) {
+	std::vector<int32_t> sourceSlots;							// old slot of every new slot
+	std::vector<Dictionary> newDictionaries;
+	std::vector<int32_t> newColumnSlots;
+	for( size_t c = 0; c < sourceColumns.size(); ++c ) {
+		int32_t slot = slotOf(sourceColumns[c]);
+		if( slot >= 0 ) {
+			newColumnSlots.resize(c + 1, -1);
+			newColumnSlots[c] = (int32_t) sourceSlots.size();
+			sourceSlots.push_back(slot);
+			newDictionaries.push_back(dictionaries[slot]);
+			newDictionaries.back().column = (table_index_t) c;
+		}
+	}
+	rewriteRows(sourceSlots.size(), [&](const RowSpan &span, SlabList &target) {
+		return remapRow(span, sourceColumns, sourceSlots, target);
+	});
+	dictionaries.swap(newDictionaries);
+	columnSlots.swap(newColumnSlots);
+	numericColumns.clear();				// cached per physical column, which have been renumbered
+}
+
+
+/**
+	materializeColumns()
+
+	Rewrites all rows in logical column order and drops the fields of deleted columns, `columnMap` is
+	the identity afterwards.
+ */
+void CsvDataStorage::materializeColumns() {
+	remapColumns(columnMap);
+	physicalColumns = columns();
+	for( table_index_t c = 0; c < physicalColumns; ++c ) {
+		columnMap[c] = c;
+	}
+	columnsInOrder = true;
 }
 
 
-std::string CsvDataStorage::setColumn(std::string rowString, table_index_t column, std::string content) {
-	std::vector<std::string> row = splitString(rowString);
-	if( (table_index_t) row.size() < numColumns ) {
-		row.resize(numColumns, "");
+/**
+	updateColumnsInOrder()
+ */
+void CsvDataStorage::updateColumnsInOrder() {
+	columnsInOrder = physicalColumns == columns();
+	for( table_index_t c = 0; columnsInOrder && c < columns(); ++c ) {
+		columnsInOrder = columnMap[c] == c;
 	}
-	if( (table_index_t) row.size() > column && column >= 0 ) {
-		row[column] = content;
+}
+
+
+/**
+	physicalRowString(const std::vector<std::string> &row)
+
+	Merges `row`, given in logical column order, to a row string in physical column order. Fields beyond
+	`columns()` are kept as long as the columns are in order, e.g. when parsing rows longer than the table.
+ */
+std::string CsvDataStorage::physicalRowString(const std::vector<std::string> &row) const {
+	if( columnsInOrder ) {
 		return mergeString(row);
+	}
+	table_index_t fields = 0;
+	for( size_t c = 0; c < row.size() && c < columnMap.size(); ++c ) {
+		fields = std::max(fields, columnMap[c] + 1);
+	}
+	std::vector<std::string> physicalRow(fields);
+	for( size_t c = 0; c < row.size() && c < columnMap.size(); ++c ) {
+		physicalRow[columnMap[c]] = row[c];
+	}
+	return mergeString(physicalRow);
+}
+
+
+/**
+	remapRow(const RowSpan &span, const std::vector<table_index_t> &sourceColumns, const std::vector<int32_t> &sourceSlots, SlabList &target)
+
+	Writes the row `span` rearranged as described by `sourceColumns` (see remapColumns()) into `target`
+	and returns the new span. Code `i` of the new record is code `sourceSlots[i]` of the old one. Neighbouring source columns are copied with a single memcpy, including
+	their delimiters. Source columns missing in a short row are treated as empty, trailing empty columns
+	that don't exist in the source row aren't created.
+ */
+CsvDataStorage::RowSpan CsvDataStorage::remapRow(const RowSpan &span, const std::vector<table_index_t> &sourceColumns, const std::vector<int32_t> &sourceSlots, SlabList &target) const {
+	const char *data = rowData(span);
+	const uint32_t *delimiters = rowDelimiters(span);
+	table_index_t sourceFields = span.delimiters + 1;
+	auto fieldStart = [&](table_index_t c) -> size_t { return c == 0 ? 0 : delimiters[c - 1] + 1; };
+	auto fieldEnd = [&](table_index_t c) -> size_t { return c < (table_index_t) span.delimiters ? delimiters[c] : span.length; };
+	auto exists = [&](table_index_t c) { return c >= 0 && c < sourceFields; };
+
+	// number of fields in the new row: up to the last one that exists in the source row
+	size_t numFields = 1;
+	for( size_t i = 0; i < sourceColumns.size(); ++i ) {
+		if( exists(sourceColumns[i]) ) {
+			numFields = i + 1;
+		}
+	}
+	size_t length = numFields - 1;
+	for( size_t i = 0; i < numFields && i < sourceColumns.size(); ++i ) {
+		if( exists(sourceColumns[i]) ) {
+			length += fieldEnd(sourceColumns[i]) - fieldStart(sourceColumns[i]);
+		}
+	}
+
+	RowSpan newSpan;
+	newSpan.length = (uint32_t) length;
+	newSpan.delimiters = (uint32_t) (numFields - 1);
+	char *record = reserveRecord(target, newSpan, sourceSlots.size());
+	uint32_t *newDelimiters = reinterpret_cast<uint32_t *>(record);
+	uint16_t *newCodes = reinterpret_cast<uint16_t *>(record + newSpan.delimiters * sizeof(uint32_t));
+	char *newData = reinterpret_cast<char *>(newCodes + sourceSlots.size());
+	const uint16_t *codes = rowCodes(span);
+	for( size_t slot = 0; slot < sourceSlots.size(); ++slot ) {
+		newCodes[slot] = codes[sourceSlots[slot]];
+	}
+
+	size_t pos = 0;
+	size_t i = 0;
+	while( i < numFields && i < sourceColumns.size() ) {
+		if( i > 0 ) {
+			newDelimiters[i - 1] = (uint32_t) pos;
+			newData[pos++] = static_cast<char>(TCRUNCHER_UTF_8_DELIMITER);
+		}
+		table_index_t first = sourceColumns[i];
+		if( !exists(first) ) {
+			++i;
+			continue;
+		}
+		// extend the run as long as the following source columns are neighbours
+		size_t j = i;
+		while( j + 1 < numFields && sourceColumns[j + 1] == sourceColumns[j] + 1 && exists(sourceColumns[j + 1]) ) {
+			++j;
+		}
+		table_index_t last = sourceColumns[j];
+		size_t runStart = fieldStart(first);
+		size_t runLength = fieldEnd(last) - runStart;
+		memcpy(newData + pos, data + runStart, runLength);
+		for( table_index_t c = first; c < last; ++c ) {
+			++i;
+			newDelimiters[i - 1] = (uint32_t) (pos + delimiters[c] - runStart);
+		}
+		pos += runLength;
+		++i;
+	}
+	return newSpan;
+}
+
+
+/**
+	encodeRow(const RowSpan &span, size_t firstNewSlot, SlabList &target)
+
+	Writes the row `span` into `target`, adding the codes of the dictionaries from `firstNewSlot` on, which have
+	just been built by encodeColumns(). Fields found in these dictionaries are left empty in the new row string.
+ */
+CsvDataStorage::RowSpan CsvDataStorage::encodeRow(const RowSpan &span, size_t firstNewSlot, SlabList &target) const {
+	const char *data = rowData(span);
+	const uint32_t *delimiters = rowDelimiters(span);
+	std::vector<uint16_t> codes(rowCodes(span), rowCodes(span) + firstNewSlot);
+	codes.resize(dictionaries.size(), 0);
+	std::string encoded;
+	std::vector<uint32_t> encodedDelimiters;
+	encoded.reserve(span.length);
+	encodedDelimiters.reserve(span.delimiters);
+	for( size_t f = 0; f <= span.delimiters; ++f ) {
+		size_t start = f == 0 ? 0 : delimiters[f - 1] + 1;
+		size_t end = f < span.delimiters ? delimiters[f] : span.length;
+		std::string_view field(data + start, end - start);
+		if( f > 0 ) {
+			encodedDelimiters.push_back( (uint32_t) encoded.size() );
+			encoded.push_back( static_cast<char>(TCRUNCHER_UTF_8_DELIMITER) );
+		}
+		int32_t slot = slotOf(f);
+		if( slot >= (int32_t) firstNewSlot ) {
+			codes[slot] = dictionaries[slot].find(field);
+			if( codes[slot] != ESCAPE_CODE ) {
+				continue;
+			}
+		}
+		encoded.append(field);
+	}
+	return writeRecord(target, encoded.data(), encoded.size(), encodedDelimiters.data(), encodedDelimiters.size(), codes.data(), codes.size());
+}
+
+
+/**
+	releaseRow(const RowSpan &span)
+
+	The record of `span` isn't referenced anymore: account it as garbage.
+ */
+void CsvDataStorage::releaseRow(const RowSpan &span) {
+	size_t size = recordSize(span);
+	liveBytes -= size;
+	deadBytes += size;
+}
+
+
+/**
+	replaceRow(long R, const std::string &rowString)
+
+	Stores rowString as the new content of row R
+ */
+void CsvDataStorage::replaceRow(table_index_t R, const std::string &rowString) {
+	RowSpan span = storeRow(rowString);
+	releaseRow(tableData.at(R));
+	tableData.set(R, span);
+}
+
+
+/**
+	compact()
+
+	Copies all live records in table order into fresh slabs and drops the old ones, when the garbage
+	outweighs the live data. Rows that are adjacent in the table are adjacent in memory afterwards.
+	Invalidates all RowSpans.
+ */
+void CsvDataStorage::compact() {
+	if( deadBytes < TCRUNCHER_COMPACT_MIN_DEAD_BYTES || deadBytes < liveBytes ) {
+		return;
+	}
+	SlabList oldSlabs;
+	oldSlabs.swap(slabs);
+	liveBytes = 0;
+	deadBytes = 0;
+	std::vector<RowSpan> spans = tableData.toVector();
+	for( RowSpan &span : spans ) {
+		const char *record = oldSlabs[span.slab]->bytes() + span.offset;
+		const uint16_t *codes = reinterpret_cast<const uint16_t *>(record + span.delimiters * sizeof(uint32_t));
+		span = storeRow(reinterpret_cast<const char *>(codes + numCodes), span.length, reinterpret_cast<const uint32_t *>(record), span.delimiters, codes);
+	}
+	tableData.assign(spans);
+}
+
+
+/**
+	recordSize(const RowSpan &span, size_t numCodes)
+
+	Bytes used by the record of `span`: delimiter positions, codes and row string, padded to a multiple of 4
+ */
+size_t CsvDataStorage::recordSize(const RowSpan &span, size_t numCodes) {
+	size_t size = span.delimiters * sizeof(uint32_t) + numCodes * sizeof(uint16_t) + span.length;
+	return (size + 3) & ~((size_t) 3);
+}
+
+size_t CsvDataStorage::recordSize(const RowSpan &span) const {
+	return recordSize(span, numCodes);
+}
+
+
+const char *CsvDataStorage::rowData(const RowSpan &span) const {
+	return reinterpret_cast<const char *>(rowCodes(span) + numCodes);
+}
+
+
+const uint32_t *CsvDataStorage::rowDelimiters(const RowSpan &span) const {
+	return reinterpret_cast<const uint32_t *>(slabs[span.slab]->bytes() + span.offset);
+}
+
+
+const uint16_t *CsvDataStorage::rowCodes(const RowSpan &span) const {
+	return reinterpret_cast<const uint16_t *>(slabs[span.slab]->bytes() + span.offset + span.delimiters * sizeof(uint32_t));
+}
+
+
+uint16_t *CsvDataStorage::rowCodes(const RowSpan &span) {
+	return reinterpret_cast<uint16_t *>(slabs[span.slab]->bytes() + span.offset + span.delimiters * sizeof(uint32_t));
+}
+
+
+/**
+	decodedRowString(const RowSpan &span)
+
+	Returns the row string of span, the fields of encoded columns filled with their values
+ */
+std::string CsvDataStorage::decodedRowString(const RowSpan &span) const {
+	if( numCodes == 0 ) {
+		return std::string(rowData(span), span.length);
+	}
+	std::string row;
+	row.reserve(span.length);
+	for( table_index_t f = 0; f <= (table_index_t) span.delimiters; ++f ) {
+		if( f > 0 ) {
+			row.push_back( static_cast<char>(TCRUNCHER_UTF_8_DELIMITER) );
+		}
+		row.append(getColumn(span, f));
+	}
+	return row;
+}
+
+
+/**
+	slotOf(long physical)
+ */
+int32_t CsvDataStorage::slotOf(table_index_t physical) const {
+	return physical >= 0 && physical < (table_index_t) columnSlots.size() ? columnSlots[physical] : -1;
+}
+
+
+
+/**
+	getColumn(const RowSpan &span, long column)
+
+	a#bcd#ef#hij
+    0123456789ab
+ */
+std::string_view CsvDataStorage::getColumn(const RowSpan &span, table_index_t column) const {
+	int32_t slot = slotOf(column);
+	if( slot >= 0 ) {
+		uint16_t code = rowCodes(span)[slot];
+		if( code != ESCAPE_CODE ) {
+			return dictionaries[slot].values[code];
+		}
+	}
+	std::pair<table_index_t,table_index_t> fromTo = getColumnIndizes(span, column);
+	if( fromTo.second > fromTo.first ) {
+		return std::string_view(rowData(span) + fromTo.first + 1, fromTo.second - fromTo.first - 1);
 	} else {
-		return rowString;
-	}	
+		return std::string_view();
+	}
+}
+
+
+/**
+	getColumnIndizes(const RowSpan &span, long column)
+
+	Returns the positions of the delimiters surrounding `column`: -1 as start position for the first
+	column, the length of the row string as end position for the last column. If the row does not
+	contain `column`, the end position is -1.
+ */
+std::pair<table_index_t,table_index_t> CsvDataStorage::getColumnIndizes(const RowSpan &span, table_index_t column) const {
+	table_index_t numDelimiters = (table_index_t) span.delimiters;
+	const uint32_t *delimiters = rowDelimiters(span);
+	table_index_t fromIdx = -1;
+	table_index_t toIdx = -1;
+	if( column < 0 || column > numDelimiters ) {
+		return std::make_pair(fromIdx, toIdx);
+	}
+	if( column > 0 ) {
+		fromIdx = delimiters[column - 1];
+	}
+	if( column < numDelimiters ) {
+		toIdx = delimiters[column];
+	} else {
+		toIdx = span.length;
+	}
+	return std::make_pair(fromIdx, toIdx);
+}
+
+
+/**
+	setColumn(long R, long column, const std::string &content)
+
+	Replaces the content of `column` in row R: the new record is spliced together from the old one, the
+	positions of all following delimiters are shifted. Rows not containing `column` get filled up with
+	empty fields first.
+	For an encoded column only the code changes – in place, unless the old value was stored in the row string
+	or the slab is shared with a copy of the storage.
+ */
+void CsvDataStorage::setColumn(table_index_t R, table_index_t column, const std::string &content) {
+	RowSpan span = tableData.at(R);
+	if( column < 0 ) {
+		return;
+	}
+	table_index_t missing = column - (table_index_t) span.delimiters;
+	if( missing > 0 ) {
+		replaceRow(R, getRow(R) + emptyCellsString(missing));
+		span = tableData.at(R);
+	}
+	std::pair<table_index_t,table_index_t> fromTo = getColumnIndizes(span, column);
+	if( fromTo.second < 0 ) {
+		return;
+	}
+	size_t start = fromTo.first + 1;
+	size_t end = fromTo.second;
+	std::vector<uint16_t> codes(rowCodes(span), rowCodes(span) + numCodes);
+	std::string_view field = content;
+	int32_t slot = slotOf(column);
+	if( slot >= 0 ) {
+		codes[slot] = dictionaries[slot].encode(content);
+		if( codes[slot] != ESCAPE_CODE ) {
+			if( end == start && slabs[span.slab].use_count() == 1 ) {
+				rowCodes(span)[slot] = codes[slot];
+				return;
+			}
+			field = std::string_view();			// the old value had been escaped, it's replaced by the code
+		}
+	}
+	const char *data = rowData(span);
+	const uint32_t *delimiters = rowDelimiters(span);
+	int64_t shift = (int64_t) field.size() - (int64_t) (end - start);
+
+	std::string rowString;
+	rowString.reserve(span.length + shift);
+	rowString.append(data, start);
+	rowString.append(field);
+	rowString.append(data + end, span.length - end);
+	std::vector<uint32_t> newDelimiters(delimiters, delimiters + span.delimiters);
+	for( size_t i = column; i < newDelimiters.size(); ++i ) {
+		newDelimiters[i] = (uint32_t) (newDelimiters[i] + shift);
+	}
+
+	RowSpan newSpan = storeRow(rowString.data(), rowString.size(), newDelimiters.data(), newDelimiters.size(), codes.data());
+	releaseRow(tableData.at(R));
+	tableData.set(R, newSpan);
+	compact();
+}
+
+
+/**
+	rowsChanged()
+
+	Called whenever rows have been added, deleted or reordered
+ */
+void CsvDataStorage::rowsChanged() {
+	numericColumns.clear();
 }
 
 
@@ -530,12 +1875,23 @@ void CsvDataStorage::dump(table_index_t numRows, bool raw) {
 	std::cout << "================================================================================================" << std::endl;
 	std::cout << "ROWS: " << R << std::endl;
 	std::cout << "COLS: " << C << std::endl;
+	std::cout << "SLABS: " << slabs.size() << " (live: " << liveBytes << " bytes, garbage: " << deadBytes << " bytes)" << std::endl;
+	if( !columnsInOrder ) {
+		std::cout << "COLUMN MAP:";
+		for( table_index_t c = 0; c < C; ++c ) {
+			std::cout << " " << columnMap[c];
+		}
+		std::cout << " (" << physicalColumns << " physical)" << std::endl;
+	}
+	for( const Dictionary &dictionary : dictionaries ) {
+		std::cout << "DICTIONARY: physical column " << dictionary.column << ", " << dictionary.values.size() << " values" << std::endl;
+	}
 	std::cout << "------------------------------------------------------------------------------------------------" << std::endl;
 	if( R > 0 && (C > 0 || raw) ) {
 		for( table_index_t r = 0; r < std::min(numRows, R); ++r ) {
 			std::cout << std::setw(3) << r << ": ";
 			if( raw ) {
-				std::cout << "|" << tableData.at(r) << "|" << std::endl;
+				std::cout << "|" << getRow(r) << "|" << std::endl;
 			} else {
 				for( table_index_t c = 0; c < C; ++c ) {
 					std::cout << "|" << std::setw(12) << get(r,c);
@@ -550,14 +1906,3 @@ void CsvDataStorage::dump(table_index_t numRows, bool raw) {
 	std::cout << "================================================================================================" << std::endl;
 	std::cout << std::setw(0);
 }
-
-
-
-
-
-
-
-
-
-
-
@@ -27,25 +27,70 @@
 #include <algorithm>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <iostream> // needed for dump()
 #include <iomanip>  // needed for dump()
 #include <chrono>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+#include <functional>
+#include <map>
 
 #include "globals.hh"
+#include "helper.hh"
+#include "blocklist.hh"
+#include "numericcolumn.hh"
+#include "radixsort.hh"
 #include "utf8-cpp-utils/utf8_cpp_utils.hh"
 
 
 /**
 	\brief Storage for the CSV data table, not including the header row.  (The Model)
 
-	The data is stored within `tableData`, a vector of strings, each string representing a single CSV row. The order of this
-	vector defines the order of the CSV rows. Each row is a `std::string`, the fields are separated by `TCRUNCHER_UTF_8_DELIMITER`.
-	This delimiter is a invalid UTF-8 byte, so it will never occur within a UTF-8 encoded cell data.
+	The bytes of all rows live in a few large slabs (`slabs`), `tableData` holds one `RowSpan` per CSV row that
+	points into these slabs. The order of this list defines the order of the CSV rows. It's a `BlockList`, so
+	inserting or deleting rows near the top of a large table only moves the spans of a single block. Within a row the fields are
+	separated by `TCRUNCHER_UTF_8_DELIMITER`. This delimiter is a invalid UTF-8 byte, so it will never occur within a
+	UTF-8 encoded cell data.
+
+	Rows don't need to have `columns()` fields: fields missing at the end of a row are read as empty and only
+	get added when they are set. So widening the table or adding empty rows doesn't rewrite any row.
+
+	Every row record in a slab starts with the byte positions of its delimiters (`uint32_t` each), followed by the
+	row string itself, so a single cell can be located in O(1) instead of scanning the row string.
+	Rewritten or deleted rows leave garbage in the slabs, which is reclaimed by `compact()` once it outweighs the
+	live data.
+
+	Copies of a storage (e.g. the undo states) share the slabs and the blocks of `tableData` with the original,
+	so copying is cheap. Shared slabs are never written to: new records go into a fresh slab and codes aren't
+	changed in place. `tableData` clones a shared block when it gets written (see `BlockList`). So a copy only
+	costs memory for the rows changed since.
+
+	Columns are addressed through `columnMap`, which maps the logical column (as seen by the callers) to the
+	physical field within the row strings. Moving, inserting and deleting columns just edits this map. The
+	fields of deleted columns stay in the rows until `materializeColumns()` rewrites them in logical order, which
+	happens once they outweigh the live columns.
+
+	Physical columns with few distinct values (country codes, status values, dates, ...) can be dictionary-encoded
+	by `encodeColumns()`, which samples every column after parsing. Each record then carries a `uint16_t` code per
+	encoded column right after its delimiter positions, the value itself is stored once in the column's `Dictionary`
+	and its field in the row string stays empty. Values that don't fit into a full dictionary are stored in the row
+	string as usual, their code is `ESCAPE_CODE`. Sorting an encoded column ranks the dictionary values once and
+	compares the ranks of the codes.
+
+	`numbers()` parses a column into a `NumericColumn` once and caches it per physical column. Setting a cell
+	updates the cached entry, anything that changes the rows (their number or order) drops all caches.
+
+	`getView()` and `rowView()` return views right into the slabs without copying. Such a view is only valid until
+	the storage gets modified (any call of a non-const method besides the getters, e.g. `set()`, `push_back()`,
+	`sort()` or the row and column operations) or destroyed. Copy it into a `std::string` if you need to keep it.
 
 	The header row is stored in `CsvTable`. That's not a great design decision and should be healed someday.
 
-	(Initially the application just used std::vector< std::vector<std::string> >, but that is really expensive in terms of memory usage.
+	(Initially the application just used std::vector< std::vector<std::string> >, later a std::vector<std::string>,
+	but both are really expensive in terms of memory usage, as every row is a heap allocation of its own.
 	This class should help in decoupling the underlying data storage from the operations of CsvTable.cpp.)
 
  */
@@ -60,35 +105,202 @@ public:
 	void clear();													  	// clears the storage
 	table_index_t rows();											  	// returns number of rows
 	table_index_t columns();										  	// returns number of columns
-	void sort(table_index_t column, bool ascending, int sortType);	  	// sorts the table according to the given options
+	enum class SortBackend { AUTO, COMPARISON, RADIX, EXTERNAL };		// how sort() orders the keys, AUTO picks by the number of rows and the memory budget
+	struct SortColumn {
+		table_index_t column;
+		bool ascending;
+		int sortType;													// 0:Numerical, 1:String, 2:String (ignore case), 3:Natural (numbers by value, ignoring case and accents)
+	};
+	void sort(table_index_t column, bool ascending, int sortType, SortBackend backend = SortBackend::AUTO);	// sorts the table according to the given options
+	void sort(const std::vector<SortColumn> &sortColumns, SortBackend backend = SortBackend::AUTO);		// stable sort by several columns, the first one has precedence
+	std::vector<table_index_t> sortedOrder(const std::vector<SortColumn> &sortColumns, SortBackend backend = SortBackend::AUTO, const std::vector<table_index_t> &base = {});	// the row order sort() would create, starting from `base`
+	void reorder(const std::vector<table_index_t> &order);				// row i becomes the former row order[i]
+	static void setSortMemoryLimit(int64_t bytes);						// sort() uses temporary files if it would need more memory – 0: a fraction of the physical memory
 	std::string get(table_index_t R, table_index_t C);				  	// gets the cell content at R,C
-	std::string getRow(table_index_t R);							  	// returns the row string (including illegal UTF-8 glue character)
+	std::string getRow(table_index_t R);							  	// returns the row string in physical column order (including illegal UTF-8 glue character)
+	std::string_view getView(table_index_t R, table_index_t C) const;	// returns a view of the cell content at R,C – see invalidation rules above
+	std::string_view rowView(table_index_t R) const;					// returns a view of the row string in physical column order – fields of encoded columns are empty
 	bool set(std::string content, table_index_t R, table_index_t C);  	// sets the content of cell at R,C – true if succeeded
-	std::vector<std::string> row(table_index_t R);					  	// returns a single row as a vector of strings with length `numColumns`
+	std::vector<std::string> row(table_index_t R);					  	// returns a single row as a vector of strings with length `columns()`
 	std::vector<std::string> rawRow(table_index_t R);				  	// returns a single row as a vector of strings, length depends on content
 	void push_back(std::string rowString);							  	// adds a row at end of the table
 	void push_back(std::vector<std::string> row);					  	// adds a row at end of the table
+	struct RowBuffer;													// a row built field by field, see below
+	void push_back(const RowBuffer &row);							  	// adds a row at end of the table
 	void push_front(std::string rowString);							  	// adds a row at the beginning of the table
 	void push_front(std::vector<std::string> row);					  	// adds a row at beginning of the table
 	void deleteRows(table_index_t rowFrom, table_index_t rowTo);		// delete rows
+	table_index_t deleteRowsIf(const std::function<bool(table_index_t)> &predicate);	// delete all rows the predicate is true for, returns their number
 	void deleteColumns(table_index_t colFrom, table_index_t colTo);	  	// delete columns
 	void insertRow(table_index_t R, table_index_t before = false);	  	// inserts a row after (or before) row R
+	void insertRows(table_index_t R, const std::vector< std::vector<std::string> > &rows);	// inserts the given rows before row R
 	void insertColumn(table_index_t C, bool before = false);			// inserts a column after (or before) column C
 	void moveColumns(table_index_t colFromStart, table_index_t colFromEnd, bool right); 		// move multiple columns to the right or left
 	bool cellContainsLineBreak(table_index_t R, table_index_t C);	  	// returns true if content of that cell contains line breaks (\n)
+	void encodeColumns();												// dictionary-encodes the columns with few distinct values
+	bool hasEncodedColumns() const;										// true if at least one column is dictionary-encoded
+	bool isEncodedColumn(table_index_t C) const;						// true if column C is dictionary-encoded
+	const std::vector<std::string> &dictionary(table_index_t C) const;	// the distinct values of an encoded column, indexed by code
+	int32_t getCode(table_index_t R, table_index_t C) const;			// the code of cell R,C within dictionary(C) – -1 if C isn't encoded or the value isn't in the dictionary
+	const NumericColumn &numbers(table_index_t C);						// the cells of column C parsed as numbers – valid until the rows change
+	const NumericColumn *cachedNumbers(table_index_t C) const;			// numbers(C) if it has already been parsed, nullptr otherwise
+	class Segment;														// rows prepared apart from the storage, see below
+	void append(Segment &segment, size_t from = 0);						// appends the rows of segment from row `from` on, the segment gets emptied
+	void moveRowsTo(Segment &segment);									// moves all rows to the end of segment, the columns stay
 	void dump(table_index_t numRows = 10, bool raw = false);		  	// DEBUG: dumps content of tableData; if `raw`: strings are displayed
 
 private:
-	std::vector<std::string> tableData; 								// holds the data
-	table_index_t numColumns = 0;										// number of columns
+	/**
+		Location of a single row within `slabs`. The record starts with `delimiters` positions (uint32_t each),
+		followed by one code per encoded column (uint16_t each) and `length` bytes of row string.
+	 */
+	struct RowSpan {
+		uint32_t slab;													// index into `slabs`
+		uint32_t offset;												// byte offset of the record within the slab, 4-byte aligned
+		uint32_t length;												// length of the row string
+		uint32_t delimiters;											// number of delimiters in the row string
+	};
+
+	/**
+		A large block of memory holding row records back to back. Slabs are only appended to, as long as they
+		aren't shared with a copy of the storage.
+	 */
+	struct Slab {
+		std::unique_ptr<uint32_t[]> words;								// the memory – uint32_t to keep the delimiter positions aligned
+		size_t capacity = 0;											// size in bytes
+		size_t used = 0;												// bytes in use
+		Slab(size_t capacity);
+		Slab(const Slab &other) = delete;
+		Slab &operator=(const Slab &other) = delete;
+		char *bytes() const { return reinterpret_cast<char *>(words.get()); }
+	};
+	typedef std::vector< std::shared_ptr<Slab> > SlabList;				// slabs, shared with the copies of the storage
+
+	/**
+		The distinct values of a dictionary-encoded physical column
+	 */
+	struct Dictionary {
+		table_index_t column;											// the physical column
+		std::vector<std::string> values;								// the values, indexed by code – code 0 is the empty string
+		std::vector<uint16_t> slots;									// hash table of the codes (linear probing), ESCAPE_CODE marks a free slot
+		Dictionary(table_index_t column);
+		uint16_t encode(std::string_view value);						// returns the code of value, adds it if necessary – ESCAPE_CODE if the dictionary is full
+		uint16_t find(std::string_view value) const;					// returns the code of value – ESCAPE_CODE if it isn't in the dictionary
+		size_t probe(std::string_view value) const;						// the slot holding value's code, or the free slot it belongs to
+		void rehash(size_t numSlots);									// rebuilds `slots` with numSlots (a power of 2) slots
+	};
+
+	BlockList<RowSpan> tableData; 										// holds the rows in table order
+	SlabList slabs;														// holds the bytes of all rows
+	size_t numCodes = 0;												// number of codes per record, equals `dictionaries.size()` except while rewriting
+	size_t liveBytes = 0;												// bytes used by records referenced from `tableData`
+	size_t deadBytes = 0;												// bytes used by records that have been rewritten or deleted
+	std::vector<table_index_t> columnMap;								// physical column of every logical column, its size is the number of columns
+	table_index_t physicalColumns = 0;									// number of physical columns, including the ones of deleted columns
+	bool columnsInOrder = true;											// true if `columnMap` is the identity and there are no deleted columns
+	std::vector<Dictionary> dictionaries;								// one per encoded column, in the order of the codes within the records
+	std::vector<int32_t> columnSlots;									// index into `dictionaries` for every physical column, -1 if not encoded (may be shorter than physicalColumns)
+	std::map<table_index_t, std::shared_ptr<NumericColumn>> numericColumns;	// parsed physical columns, see numbers() – shared with copies
 	static const unsigned char TCRUNCHER_UTF_8_DELIMITER = 0xFA;		// this byte is used as a separator for fields within std::string (it's an invalid UTF-8 character)
+	static constexpr size_t TCRUNCHER_SLAB_SIZE = 4 * 1024 * 1024;			// default size of a slab in bytes
+	static constexpr size_t TCRUNCHER_COMPACT_MIN_DEAD_BYTES = 16 * 1024 * 1024;	// don't compact for less garbage than this
+	static constexpr size_t TCRUNCHER_PARALLEL_MIN_ROWS = 50000;		// rows handled by a single thread at least
+	static constexpr size_t TCRUNCHER_RADIX_SORT_MIN_ROWS = 100000;		// SortBackend::AUTO uses the radix sort from this number of rows on
+	static constexpr double TCRUNCHER_SORT_MEMORY_FRACTION = 0.25;		// default memory budget of sort() as fraction of the physical memory
+	static constexpr size_t TCRUNCHER_EXTERNAL_SORT_MIN_CHUNK_ROWS = 100000;	// rows sorted in memory at least when sorting with temporary files
+	inline static int64_t sortMemoryLimit = 0;							// see setSortMemoryLimit()
+	static constexpr uint16_t ESCAPE_CODE = 0xFFFF;						// code of values that are stored in the row string
+	static constexpr size_t TCRUNCHER_ENCODE_MIN_ROWS = 10000;			// smaller tables aren't dictionary-encoded
+	static constexpr size_t TCRUNCHER_ENCODE_SAMPLE_ROWS = 10000;		// rows sampled per column to estimate its cardinality
+	static constexpr size_t TCRUNCHER_ENCODE_MAX_SAMPLED_VALUES = 1000;	// columns with more distinct values within the sample aren't encoded
 
 	static std::vector<std::string> splitString(std::string str);								 // splits a string at the internal CSV delimiter
 	static std::string mergeString(std::vector<std::string> row);								 // merges the vector to a string
-	static std::pair<table_index_t, table_index_t> getColumnIndizes(std::string rowString, table_index_t column); // returns the positions of the surrounding bytes
-	static std::string getColumn(std::string row, table_index_t column);						 // gets the content of `column` in string row
-	std::string setColumn(std::string row, table_index_t column, std::string content);			 // sets the content of `column` in row and returns the new string
+	RowSpan storeRow(const std::string &rowString);												 // copies the row string into the slabs and returns its span
+	RowSpan storeRow(const char *data, size_t length, const uint32_t *delimiters, size_t numDelimiters, const uint16_t *codes);	// copies a prepared record into the slabs
+	static char *reserveRecord(SlabList &target, RowSpan &span, size_t numCodes);		 // reserves room for the record of span in target
+	static RowSpan writeRecord(SlabList &target, const char *data, size_t length, const uint32_t *delimiters, size_t numDelimiters, const uint16_t *codes, size_t numCodes);	// copies a prepared record into target
+	void rewriteRows(size_t newNumCodes, const std::function<RowSpan(const RowSpan &, SlabList &)> &rewrite);	// replaces every row by a rewritten one in fresh slabs
+	void remapColumns(const std::vector<table_index_t> &sourceColumns);						 // rebuilds all rows from the given source columns
+	void materializeColumns();																	 // rewrites all rows in logical column order
+	void updateColumnsInOrder();																 // recalculates `columnsInOrder` after `columnMap` has been changed
+	std::string physicalRowString(const std::vector<std::string> &row) const;					 // merges a row given in logical column order to a row string
+	RowSpan remapRow(const RowSpan &span, const std::vector<table_index_t> &sourceColumns, const std::vector<int32_t> &sourceSlots, SlabList &target) const; // builds a single remapped row in target
+	RowSpan encodeRow(const RowSpan &span, size_t firstNewSlot, SlabList &target) const; // builds a single row in target with the codes of the dictionaries from firstNewSlot on
+	int32_t slotOf(table_index_t physical) const;												 // index into `dictionaries` of a physical column, -1 if not encoded
+	void releaseRow(const RowSpan &span);														 // marks the record of span as garbage
+	void replaceRow(table_index_t R, const std::string &rowString);								 // replaces row R by rowString
+	void compact();																				 // copies all live records into fresh slabs, if worthwhile
+	static size_t recordSize(const RowSpan &span, size_t numCodes);								 // bytes used by the record of span, including padding
+	size_t recordSize(const RowSpan &span) const;												 // bytes used by the record of span with the current number of codes
+	const char *rowData(const RowSpan &span) const;												 // returns the row string of span
+	const uint32_t *rowDelimiters(const RowSpan &span) const;									 // returns the delimiter positions of span
+	const uint16_t *rowCodes(const RowSpan &span) const;										 // returns the codes of span
+	uint16_t *rowCodes(const RowSpan &span);													 // returns the codes of span, to be changed in place
+	std::string decodedRowString(const RowSpan &span) const;									 // returns the row string of span with the values of the encoded columns
+	std::pair<table_index_t, table_index_t> getColumnIndizes(const RowSpan &span, table_index_t column) const; // returns the positions of the surrounding bytes
+	std::string_view getColumn(const RowSpan &span, table_index_t column) const;				 // gets the content of `column` in row
+	void setColumn(table_index_t R, table_index_t column, const std::string &content);			 // sets the content of `column` in row R
 	static std::string emptyCellsString(table_index_t num);										 // returns strings of delimiters
+	// a sort column as needed by encodeSortKey()
+	struct SortKeyColumn {
+		SortColumn sortColumn;
+		table_index_t physical;
+		int32_t slot;
+		const NumericColumn *numbers = nullptr;							// numeric columns only
+		bool integers = false;											// numeric column without decimals
+		std::vector<std::string> values;								// dictionary values, transformed by sortText() for sort types 2 and 3
+	};
+	std::vector<table_index_t> sortedOrderExternal(const std::vector<SortColumn> &sortColumns, const std::vector<table_index_t> &base);	// sortedOrder() using temporary files, empty if they aren't available
+	std::string encodeSortKey(const std::vector<SortKeyColumn> &keyColumns, size_t R, size_t position) const;	// the sort keys of row R as byte-wise comparable string
+	int64_t sortKeyBytes(const std::vector<SortColumn> &sortColumns);							 // estimated memory per row for sorting
+	int64_t sortWorkingSet(const std::vector<SortColumn> &sortColumns);							 // estimated memory for sorting in memory
+	static int64_t sortMemoryBudget();															 // memory sort() may use
+	static std::string sortText(int sortType, std::string_view s);								 // what's compared instead of s for the sort types 2 and 3
+	static uint64_t keyPrefix(std::string_view s);												 // the first 8 bytes of s as big-endian integer, for sorting
+	void rowsChanged();																			 // drops everything cached per row
+};
+
+
+/**
+	\brief A row built field by field, e.g. by the parser, in the format of the row records.
+
+	`data` holds the fields in logical column order, separated by `TCRUNCHER_UTF_8_DELIMITER`, and `delimiters` the
+	positions of these separators. So the row gets copied into the slabs as it is. Reuse a buffer for many rows to
+	avoid allocations.
+ */
+struct CsvDataStorage::RowBuffer
+{
+	std::string data;													// the fields, separated by TCRUNCHER_UTF_8_DELIMITER
+	std::vector<uint32_t> delimiters;									// positions of the separators within `data`
+
+	void clear() { data.clear(); delimiters.clear(); }
+	void endField() { delimiters.push_back( (uint32_t) data.size() ); data.push_back( static_cast<char>(TCRUNCHER_UTF_8_DELIMITER) ); }
+	size_t fields() const { return delimiters.size() + 1; }
+};
+
+
+/**
+	\brief Rows stored into slabs of their own, apart from any storage.
+
+	A segment can be filled on any thread, e.g. by a parser thread handling a part of a file. `CsvDataStorage::append()`
+	then takes over its slabs without copying the rows, as long as the storage's columns are in order and not encoded.
+	`CsvDataStorage::moveRowsTo()` is the way back, e.g. to hand the rows a thread has stored over to another one.
+	The fields of a row are in logical column order.
+ */
+class CsvDataStorage::Segment
+{
+
+public:
+	void push_back(const RowBuffer &row);								// adds a row at the end of the segment
+	size_t size() const;												// returns the number of rows
+	size_t fields(size_t i) const;										// returns the number of fields of row i
+	void shrink();														// releases the unused end of the last slab, once the segment is complete
+
+private:
+	friend class CsvDataStorage;
+	SlabList slabs;														// holds the records of the rows, without codes
+	std::vector<RowSpan> spans;											// the rows in order
 };
 
 #endif
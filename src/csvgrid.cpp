@@ -76,6 +76,9 @@ int CsvGrid::handle(int event) {
 
 	switch (event) {
 		case FL_KEYBOARD:							// key press in table?
+			if( readOnly ) {
+				break;
+			}
 			if( Fl::event_key() == FL_Tab && !Fl::event_command() && !Fl::event_ctrl() && !Fl::event_alt() ) {
 				// TAB
 				doneEditing();
@@ -157,7 +160,7 @@ int CsvGrid::handle(int event) {
 				}
 				windows[app.getTopWindow()].showDefaultStatus();
 			}
-			if( Fl::event_clicks() && Fl::event_button() == FL_LEFT_MOUSE ) {
+			if( Fl::event_clicks() && Fl::event_button() == FL_LEFT_MOUSE && !readOnly ) {
 				// Double Left Click
 				doneEditing();						// finish any previous editing
 				updateSelection(R,C,R,C);
@@ -187,13 +190,21 @@ bool CsvGrid::areEventsAllowed() {
 }
 
 
+void CsvGrid::setReadOnly(bool readOnly) {
+	if( readOnly ) {
+		doneEditing(false);
+	}
+	this->readOnly = readOnly;
+}
+
+
 // Handle drawing all cells in table
 void CsvGrid::draw_cell(TableContext context, int R,int C, int X,int Y,int W,int H) {
 	DEBUG_PRINTF("#### CsvGrid::draw_cell: %d, %d\n", R, H);
 	int cell_orientation = FL_ALIGN_LEFT;
 	int row_top=-1, col_left=-1, row_bot=-1, col_right=-1;						// the previous selection
 	static char s[TCRUNCHER_MAX_CELL_LENGTH + 1];
-	std::tuple<int, int> lastFound = app.lastFoundPosition();
+	std::tuple<table_index_t, table_index_t> lastFound = app.lastFoundPosition();
 
 	get_selection(row_top, col_left, row_bot, col_right);
 	switch( context ) {
@@ -281,10 +292,16 @@ void CsvGrid::draw_cell(TableContext context, int R,int C, int X,int Y,int W,int
 			}
 			fl_rectf(X,Y,W,H);
 
+			// copy the cell content once into `s` – fl_measure() and fl_draw() need a zero-terminated string
+			std::string_view cellView = dataTable->getCellView(R,C);
+			size_t cellLength = std::min(cellView.size(), (size_t) TCRUNCHER_MAX_CELL_LENGTH);
+			memcpy(s, cellView.data(), cellLength);
+			s[cellLength] = '\0';
+
 			// draw a visual hint when cell contains multiline content
 			int textWidth = 0, textHeight = 0;
 			fl_font(app.getCustomFont(CsvApplication::FontUsage::TEXT), text_font_size);
-			fl_measure( dataTable->getCell(R,C).c_str(), textWidth, textHeight );
+			fl_measure( s, textWidth, textHeight );
 			if( textWidth > W || textHeight > H ) {
 				fl_color(ColorThemes::getColor(app.getTheme(), "cell_ellipsis"));
 				fl_rectf(X+W-5,Y+H-5,3,3);
@@ -315,11 +332,11 @@ void CsvGrid::draw_cell(TableContext context, int R,int C, int X,int Y,int W,int
 					}
 				}
 				if( R < dataTable->getNumberRows() && C < dataTable->getNumberCols() ) {
-					if( Helper::isNumber(dataTable->getCell(R,C).c_str()) )
+					if( Helper::isNumber(cellView) )
 						cell_orientation = FL_ALIGN_RIGHT;
 					else
 						cell_orientation = FL_ALIGN_LEFT;
-					fl_draw(dataTable->getCell(R,C).c_str(), X+3, Y+3, W-6, H-6, cell_orientation, 0, 0);
+					fl_draw(s, X+3, Y+3, W-6, H-6, cell_orientation, 0, 0);
 				} else {
 					fl_draw("", X+3,Y+3,W-6,H-6, cell_orientation);
 				}
@@ -378,7 +395,7 @@ void CsvGrid::event_callback2() {
 			switch(event) {
 				case FL_RELEASE:
 					DEBUG_PRINTF(".... CONTEXT_COL_HEADER > FL_RELEASE\n");
-					if( Fl::event_button() == FL_RIGHT_MOUSE && !Fl::event_command() && !Fl::event_shift() && !Fl::event_ctrl() && !Fl::event_alt() ) {
+					if( Fl::event_button() == FL_RIGHT_MOUSE && !Fl::event_command() && !Fl::event_shift() && !Fl::event_ctrl() && !Fl::event_alt() && !readOnly ) {
 						// Col Header Right_Click
 						app.sort(C);
 					}
@@ -393,8 +410,9 @@ void CsvGrid::event_callback2() {
 			switch(event) {
 				case FL_RELEASE:
 					DEBUG_PRINTF(".... CONTEXT_ROW_HEADER > FL_RELEASE\n");
-					if( Fl::event_button() == FL_LEFT_MOUSE && Fl::event_alt() && !Fl::event_command() && !Fl::event_ctrl() && !Fl::event_shift() ) {
+					if( Fl::event_button() == FL_LEFT_MOUSE && Fl::event_alt() && !Fl::event_command() && !Fl::event_ctrl() && !Fl::event_shift() && !readOnly ) {
 						// Row Header Alt-Left_Click
+						windows[app.getTopWindow()].addUndoStateFlags("Flag Row");
 						if( windows[app.getTopWindow()].table->isFlagged(R) ) {
 							windows[app.getTopWindow()].table->flagRow(R, false);
 						} else {
@@ -455,9 +473,12 @@ void CsvGrid::doneEditing(bool save) {
 
 
 
-// Sets the visible area of the table in a way that the given cell is central
-void CsvGrid::setVisibleArea(int R, int C) {
-	DEBUG_PRINTF("#### CsvGrid::setVisibleArea: %d, %d\n", R, C);
+// Sets the visible area of the table in a way that the given cell is central – rows beyond the grid are ignored
+void CsvGrid::setVisibleArea(table_index_t R, table_index_t C) {
+	DEBUG_PRINTF("#### CsvGrid::setVisibleArea: %lld, %lld\n", (long long) R, (long long) C);
+	if( !isDisplayed(R) ) {
+		return;
+	}
 	int r1, r2, c1, c2;
 	visible_cells(r1, r2, c1, c2);
 	if( C >= c2 ) {
@@ -500,11 +521,42 @@ void CsvGrid::deleteSelection() {
 
 void CsvGrid::selectAll() {
 	DEBUG_PRINTF("#### CsvGrid::selectAll\n");
-	updateSelection(0, 0, dataTable->getNumberRows()-1, dataTable->getNumberCols()-1);
+	updateSelection(0, 0, rows()-1, dataTable->getNumberCols()-1);
+}
+
+
+/**
+ *	Sets the number of rows shown. Fl_Table handles rows as int and sums up their heights in pixels, so
+ *	at most TCRUNCHER_MAX_GRID_ROWS rows are shown; the rest of the table is still there for saving,
+ *	searching, sorting and macros.
+ */
+void CsvGrid::setTableRows(table_index_t R) {
+	DEBUG_PRINTF("#### CsvGrid::setTableRows\n");
+	truncated = R > TCRUNCHER_MAX_GRID_ROWS;
+	rows( truncated ? TCRUNCHER_MAX_GRID_ROWS : (int) R );
+}
+
+
+bool CsvGrid::isTruncated() {
+	return truncated;
+}
+
+
+bool CsvGrid::isDisplayed(table_index_t R) {
+	return R >= 0 && R < rows();
+}
+
+
+/**
+ *	Callers that found a row by searching the table (find, jump to row, flagged rows) show this message instead of
+ *	selecting a row the grid doesn't have.
+ */
+std::string CsvGrid::beyondGridMessage(table_index_t R) {
+	return "Row " + std::to_string(R + 1) + " lies beyond the displayed part of the table (the first " + std::to_string(TCRUNCHER_MAX_GRID_ROWS) + " rows).";
 }
 
 
-std::vector<int> CsvGrid::getSelection() {
+std::vector<table_index_t> CsvGrid::getSelection() {
 	DEBUG_PRINTF("#### CsvGrid::getSelection\n");
 	int s_left, s_top, s_right, s_bottom;
 	get_selection(s_top, s_left, s_bottom, s_right);
@@ -52,9 +52,14 @@ public:
 	CsvGrid(int X,int Y,int W,int H,const char* L=0);
 	~CsvGrid();
 	void setDataTable(CsvTable *dataTable);				// points to the data table
+	void setTableRows(table_index_t R);					// sets the number of grid rows to R, but not more than TCRUNCHER_MAX_GRID_ROWS
+	bool isTruncated();									// true if the table has more rows than the grid shows
+	bool isDisplayed(table_index_t R);					// true if table row R is one of the grid rows
+	static std::string beyondGridMessage(table_index_t R);	// tells that table row R can't be shown by the grid
 	void allowEvents(bool allow);						// call with false to forbid reacting to events
 	bool areEventsAllowed();							// returns true if events are allowed
-	void setVisibleArea(int R, int C);					// Sets the visible area of the table in a way that the given cell is central
+	void setReadOnly(bool readOnly);					// call with true to allow scrolling and selecting only, e.g. while a file is being loaded
+	void setVisibleArea(table_index_t R, table_index_t C);	// Sets the visible area of the table in a way that the given cell is central
 	void setDeletionHighlight(bool, int, int);			// set deletion highlights
 	void removeDeletionHighlight();
 	void biggerFont();
@@ -62,7 +67,7 @@ public:
 	void defaultFont();
 	void updateSelection(int row_top, int col_left, int row_bottom, int col_right);
 	void deleteSelection();								// deletes the content of the selected cells
-	std::vector<int> getSelection();					// returns selection as a vector
+	std::vector<table_index_t> getSelection();			// returns selection as a vector
 	void moveSelection(int rows, int cols);				// moves the selection (e.g. after inserting rows or cols)
 	void selectAll();									// deletes the content of the selected cells
 	int handle(int);
@@ -89,7 +94,9 @@ private:
 	TCRUNCHER_CSVGRID_INPUT_WIDGET *input;				// single instance of CODE_INPUT_WIDGET widget
 	char input_buffer[TCRUNCHER_MAX_CELL_LENGTH+1];		// storage for the input of CODE_INPUT_WIDGET
 	bool eventsAllowed = true;							// false: don't react to events
+	bool readOnly = false;								// true: cells can't be edited, rows not flagged or sorted
 	bool deletionHighlight = false;						// show deletion highlight
+	bool truncated = false;								// true if the grid doesn't show all rows of the table
 	
 	void setValueHide(bool save=true);					// writes the entered string back to the dataTable (if save is true) and hides the input
 	void startEditing(int R, int C);					
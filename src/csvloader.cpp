@@ -0,0 +1,140 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Stefan Fischerländer
+ *
+ * This file is part of Tablecruncher.
+ *
+ * Tablecruncher is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * Tablecruncher is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tablecruncher. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+/************************************************************************************
+*
+*	CsvLoader
+*
+************************************************************************************/
+
+
+#include "csvloader.hh"
+
+
+
+/**
+ *	Takes over the opened `input` and starts parsing it on the worker thread. `wake(data)` gets called on the main
+ *	thread whenever there are rows to collect.
+ */
+CsvLoader::CsvLoader(std::ifstream &&input, CsvDefinition definition, long fileLength, Fl_Awake_Handler wake, void *data) :
+	input(std::move(input)), definition(definition), fileLength(fileLength), wake(wake), wakeData(data) {
+	worker = std::thread(&CsvLoader::run, this);
+}
+
+
+CsvLoader::~CsvLoader() {
+	cancel();
+}
+
+
+/**
+ *	Appends the rows published since the last call to `storage` and widens it, if necessary. Call it on the main
+ *	thread only, always with the same storage.
+ *	Returns true once the worker is finished and all of its rows have been appended.
+ */
+bool CsvLoader::collect(CsvDataStorage &storage) {
+	std::deque<CsvDataStorage::Segment> ready;
+	table_index_t readyColumns;
+	bool done;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ready.swap(segments);
+		readyColumns = columns;
+		done = finished;
+	}
+	if( storage.columns() < readyColumns ) {
+		storage.resize(0, readyColumns);
+	}
+	for( CsvDataStorage::Segment &segment : ready ) {
+		storage.append(segment);
+	}
+	return done;
+}
+
+
+void CsvLoader::cancel() {
+	cancelled = true;
+	if( worker.joinable() ) {
+		worker.join();
+	}
+}
+
+
+bool CsvLoader::isComplete() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return finished && !stopped;
+}
+
+
+int CsvLoader::percent() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if( fileLength <= 0 ) {
+		return 0;
+	}
+	return (int) std::min<size_t>(100, bytes * 100 / fileLength);
+}
+
+
+std::map<table_index_t,table_index_t> CsvLoader::rowLengths() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return histogram;
+}
+
+
+/*
+	The worker: parses the whole file and publishes the rows batch by batch
+ */
+void CsvLoader::run() {
+	CsvParser parser;
+	std::map<table_index_t,table_index_t> lengths = parser.parseCsvSegments(&input, &definition, [this](CsvDataStorage::Segment &rows, table_index_t rowColumns, size_t rowBytes, bool complete) {
+		bool stop = cancelled && !complete;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			segments.push_back( std::move(rows) );
+			columns = rowColumns;
+			bytes = rowBytes;
+			stopped = stop;
+		}
+		wakeMainThread(false);
+		return !stop;
+	});
+	input.close();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		histogram = std::move(lengths);
+		finished = true;
+	}
+	wakeMainThread(true);
+}
+
+
+/*
+	Wakes the main thread, but not more often than every TCRUNCHER_LOADER_WAKE_SECONDS – unless `always`
+ */
+void CsvLoader::wakeMainThread(bool always) {
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if( always || now - lastWake >= std::chrono::duration<double>(TCRUNCHER_LOADER_WAKE_SECONDS) ) {
+		lastWake = now;
+		Fl::awake(wake, wakeData);
+	}
+}
@@ -0,0 +1,91 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Stefan Fischerländer
+ *
+ * This file is part of Tablecruncher.
+ *
+ * Tablecruncher is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * Tablecruncher is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tablecruncher. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef _CSVLOADER_HH
+#define _CSVLOADER_HH
+
+
+#include <string>
+#include <fstream>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#include <FL/Fl.H>
+
+#include "globals.hh"
+#include "csvdatastorage.hh"
+#include "csvparser.hh"
+
+
+
+/**
+ * \brief Parses a CSV file on a worker thread, so its window can show the rows loaded so far.
+ * 
+ * The worker parses the file with `CsvParser::parseCsvSegments()` and publishes the rows in segments. It never
+ * touches the table: the main thread calls `collect()` to append the published segments to the table's storage,
+ * which takes over their slabs without copying the rows. The worker wakes the main thread by `Fl::awake()` – at
+ * most every TCRUNCHER_LOADER_WAKE_SECONDS and once it's finished – so `Fl::lock()` has to be called once
+ * before.
+ * 
+ * Deleting the loader stops the worker and waits for it.
+ * 
+ */
+class CsvLoader {
+public:
+	CsvLoader(std::ifstream &&input, CsvDefinition definition, long fileLength, Fl_Awake_Handler wake, void *data);
+	~CsvLoader();
+	bool collect(CsvDataStorage &storage);				// appends the published rows to storage – true once the last ones have been appended
+	void cancel();										// stops the worker after the current batch and waits for it
+	bool isComplete();									// true if the worker has published all rows of the file
+	int percent();										// part of the file parsed so far, in percent
+	std::map<table_index_t,table_index_t> rowLengths();	// histogram of the row lengths – complete once collect() returned true
+
+private:
+	static constexpr double TCRUNCHER_LOADER_WAKE_SECONDS = 0.2;	// minimal time between two wakes of the main thread
+
+	std::ifstream input;
+	CsvDefinition definition;
+	long fileLength;
+	Fl_Awake_Handler wake;								// called on the main thread when there are rows to collect
+	void *wakeData;
+	std::chrono::steady_clock::time_point lastWake;		// used by the worker only
+	std::atomic<bool> cancelled{false};
+	std::mutex mutex;									// guards the members below
+	std::deque<CsvDataStorage::Segment> segments;		// published, but not collected yet
+	table_index_t columns = 0;							// number of columns of the rows published so far
+	size_t bytes = 0;									// bytes of the file parsed so far
+	std::map<table_index_t,table_index_t> histogram;	// set by the worker when it's finished
+	bool finished = false;								// the worker has published its last segment
+	bool stopped = false;								// the worker has been cancelled before the end of the file
+	std::thread worker;									// started last, when everything else is set up
+
+	void run();
+	void wakeMainThread(bool always);
+};
+
+
+#endif
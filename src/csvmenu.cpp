@@ -25,6 +25,7 @@
 
 extern Fl_Preferences preferences;
 extern CsvApplication app;
+extern CsvWindow windows[];
 
 
 #ifdef __APPLE__
@@ -184,6 +185,29 @@ void CsvMenu::updateOpenRecentMenu(std::vector<std::string> files) {
 
 
 
+/*
+ *	Returns true if the menu item at `path` changes or saves the table – not allowed while a file is being loaded
+ */
+bool CsvMenu::changesTable(const char *path) {
+	static const char *prefixes[] = {
+		"&File/&Reopen", "&File/&Save", "&File/&Split CSV", "&File/&Export JSON", "&File/&Set CSV Properties",
+		"&Edit/", "&Data/", "&Macro/", "&View/&Switch Header Row"
+	};
+	static const char *exceptions[] = {"&Edit/&Copy", "&Edit/&Preferences...", "&Data/&Find ..."};
+	for( const char *exception : exceptions ) {
+		if( strcmp(path, exception) == 0 ) {
+			return false;
+		}
+	}
+	for( const char *prefix : prefixes ) {
+		if( strncmp(path, prefix, strlen(prefix)) == 0 ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
 void CsvMenu::MyMenuCallback(Fl_Widget *w, void *data) {
 	char ipath[256];
 		
@@ -191,6 +215,11 @@ void CsvMenu::MyMenuCallback(Fl_Widget *w, void *data) {
 	const Fl_Menu_Item *item = bar->mvalue();								// Get the menu item that was picked
 	bar->item_pathname(ipath, sizeof(ipath));								// Get full pathname of picked item
 
+	if( windows[app.getTopWindow()].isLoading() && changesTable(ipath) ) {
+		CsvApplication::myFlChoice("Info", "The file is still being loaded. Press Esc to stop loading.", {"OK"});
+		return;
+	}
+
 	if( strcmp(item->label(), "&New") == 0 ) {
 		app.createNewWindow();
 	} else if( strcmp(item->label(), TCRUNCHER_MENUTEXT_OPEN) == 0 ) {
@@ -71,6 +71,7 @@ public:
 
 private:
 	static void MyMenuCallback(Fl_Widget *w, void *data);
+	static bool changesTable(const char *path);
 	const int INTEGERS[TCRUNCHER_MENU_NUM_INTEGERS] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
 	
 	// std::string undoLabelText;
@@ -30,90 +30,124 @@
 #include "csvparser.hh"
 
 
-#ifndef TCRUNCHER_PARSER_WITHOUT_UPDATE
-// needed for updateStatusbar()
-extern CsvApplication app;
-extern CsvWindow windows[];
-#endif
-
-
 /**
  *	\brief Parses 'input' and stores the CSV data into the given `CsvDataStorage` object.
 
  *	'definition' tells what CSV dialect is used.
- *	The vec-of-vec gets enlarged while ensuring all vectors have the same length.
+ *	The number of columns of the storage is the length of the longest row, shorter rows are stored unpadded.
+ *	Afterwards columns with few distinct values get dictionary-encoded, see `CsvDataStorage::encodeColumns()`.
+ *	Complete 8-bit encoded streams are parsed by all cores, see parseCsvParallel().
 
  *	IMPORTANT: Update any variables afterwards that store the dimension of the table.
  *	
- *	\param input The stream that should get parsed
- *	\param storage The `CsvDataStorage` object where the data gets stored using `push_back()`.
+ *	\param input The stream that should get parsed – it's read ahead in large blocks, so its position is undefined afterwards
+ *	\param storage The `CsvDataStorage` object where the data gets stored using `push_back()` and `append()`.
  *	\param definition Pointer to the definition of the CSV data in `input`.
  *	\param maxLines	maximum number of lines to return – used for probing
- *	\param resizeRows	True: resize rows, all rows have the same length, False: don't resize – used for probing.
- *				if !resize: CsvDataStorage::numColumns doesn't get updated!
+ *	\param resizeRows	True: resize the storage to the longest row, False: don't resize – used for probing.
+ *				if !resize: CsvDataStorage::columns() doesn't get updated!
  *
  *	@return		list indicating different row lengths
 
  */
-std::map<long,long> CsvParser::parseCsvStream( std::istream *input, CsvDataStorage &storage, CsvDefinition *definition, int maxLines, bool resizeRows ) {
+std::map<table_index_t,table_index_t> CsvParser::parseCsvStream( std::istream *input, CsvDataStorage &storage, CsvDefinition *definition, int maxLines, bool resizeRows ) {
+	Progress progress;
+
+	parseRows(input, storage, definition, maxLines, resizeRows, progress);
+	// a fully parsed table gets its low-cardinality columns dictionary-encoded
+	finishStorage(storage, !maxLines && resizeRows);
+
+	// #ifdef DEBUG
+	// printf("rowLengths: %zu\n", progress.rowLengths.size());
+	// for( auto const & kv : progress.rowLengths) {
+	// 	printf("Length %ld: %ld\n", kv.first, kv.second);
+	// }
+	// #endif
+	
+	return progress.rowLengths;
+}
+
+
+/**
+ *	\brief Parses 'input' like parseCsvStream(), but hands the rows over to `handler` in segments instead of storing them.
+
+ *	Meant to run on a thread of its own while the rows are shown: `handler` gets called on the calling thread
+ *	after every batch of lines with the rows parsed since its last call, the number of columns of the table so far
+ *	and the bytes of `input` parsed so far. It returns false to stop parsing. Its last call has `complete` set and
+ *	comes only if parsing hasn't been stopped. Append the segments to a storage in the order they come in and call
+ *	finishStorage() after the complete one.
+ *
+ *	@return		list indicating different row lengths
+ */
+std::map<table_index_t,table_index_t> CsvParser::parseCsvSegments( std::istream *input, CsvDefinition *definition, const SegmentHandler &handler ) {
+	CsvDataStorage staging;								// holds the rows until they are handed over
+	Progress progress;
+	bool stopped = false;
+
+	publishRows = [&handler, &stopped](CsvDataStorage &storage, const Progress &progress, bool complete) {
+		CsvDataStorage::Segment rows;
+		storage.moveRowsTo(rows);
+		rows.shrink();
+		stopped = !handler(rows, storage.columns(), progress.bytes, complete);
+		return !stopped;
+	};
+	parseRows(input, staging, definition, 0, true, progress);
+	if( !stopped ) {
+		publishRows(staging, progress, true);
+	}
+	publishRows = nullptr;
+	return progress.rowLengths;
+}
+
+
+/**
+ *	Completes a storage filled by the parser: deletes the row of the empty line every stream ends with and, if
+ *	`encode`, dictionary-encodes the columns with few distinct values.
+ */
+void CsvParser::finishStorage(CsvDataStorage &storage, bool encode) {
+	// Delete last row if storage is not empty
+	if( storage.rows() )
+		storage.deleteRows( storage.rows() - 1, storage.rows() - 1 );
+	
+	if( encode ) {
+		storage.encodeColumns();
+	}
+}
+
+
+/*
+	Parses the lines of `input` into `storage` – everything parseCsvStream() does but finishing the storage
+ */
+void CsvParser::parseRows(std::istream *input, CsvDataStorage &storage, CsvDefinition *definition, int maxLines, bool resizeRows, Progress &progress) {
 	std::string line;
-	std::stringstream sstr;
-	long act_rows = 0;
-	long act_cols = 0;
-	std::vector<std::string> vec;
-	std::map<long,long> rowLengths;
+	CsvDataStorage::RowBuffer row;						// the row being parsed, reused for all rows
 	
+	// a parser gets reused for probing: don't continue a quoted field left open by the previous stream
+	parseCsvState = CSVPARSER_CONST_NOT_ENCLOSED;
+
 	// skip bomBytes
 	input->ignore(definition->bomBytes);
+	LineReader reader(input->rdbuf());
+
+	// complete 8-bit encoded files are parsed in parallel
+	if( !maxLines && input->good() && (
+		definition->encoding == CsvDefinition::ENC_UTF8 ||
+		definition->encoding == CsvDefinition::ENC_Latin1 ||
+		definition->encoding == CsvDefinition::ENC_Latin9 ||
+		definition->encoding == CsvDefinition::ENC_Win1252
+	) ) {
+		parseCsvParallel(input, reader, storage, definition, resizeRows, progress);
+	}
 
 	// read lines from istream `input` into `line`
-	while( myGetlineEncodings( *input, line, definition->encoding) ) {
-		if( parseCsvState == CSVPARSER_CONST_NOT_ENCLOSED ) {
-			// if this line has been fully parsed, clear previous line vector
-			vec.clear();
-		}
-
+	while( !input->eof() && myGetlineEncodings( *input, reader, line, definition->encoding) ) {
 		// translate encodings to valid UTF-8
-		switch( definition->encoding ) {
-			case CsvDefinition::ENC_NONE:
-			case CsvDefinition::ENC_UTF8:
-				Helper::fixUtf8(line);				// replaces invalid chars with replacement char
-			break;
-			case CsvDefinition::ENC_Latin1:
-				line = Helper::latin1toutf8(line);
-			break;
-			case CsvDefinition::ENC_Win1252:
-				line = Helper::win1252toutf8(line);
-			break;
-			case CsvDefinition::ENC_UTF16LE:			// translation happens in myGetlineEncodings()
-			case CsvDefinition::ENC_UTF16BE:			// translation happens in myGetlineEncodings()
-			default:
-			break;
-		}
-		// parse `line` and put cells into `vec`
-		parseCsvLine(vec, line, definition);
+		translateEncoding(line, definition);
+		// parse `line` and put cells into `row`
+		parseCsvLine(row, line, definition);
 		if( parseCsvState == CSVPARSER_CONST_NOT_ENCLOSED ) {
-			// if this line has been fully parsed
-			
-			// calculate histogram data
-			size_t vecSize = vec.size();
-			if( input->rdstate() != std::ios_base::eofbit ) {
-				// only record when we're not at the last line
-				rowLengths[vecSize]++;
-			}
-			
-			// resize rows
-			if( resizeRows && vec.size() ) {
-				if( act_cols < (long)vec.size() ) {
-					// parsed line is longer than columns(): resize storage
-					storage.resize(0, (long)vec.size());
-				} else if( act_cols > (long)vec.size() ) {
-					// die aktuelle Zeile ist kürzer als die bisherigen Zeilen: die aktuelle Zeile verlängern
-					vec.resize( act_cols );
-				}
-				act_cols = std::max( act_cols, (long)vec.size() );
-			}
-			
+			// if this line has been fully parsed: only record its length when we're not at the last line
+			countRow(progress, storage, row.fields(), input->rdstate() != std::ios_base::eofbit, resizeRows);
 
 // #ifdef DEBUG
 // printf("--------------------------------------\n");
@@ -122,44 +156,204 @@ std::map<long,long> CsvParser::parseCsvStream( std::istream *input, CsvDataStora
 // printf("ESC: %c\n", definition->escape);
 // printf("QUO: %c\n", definition->quote);
 // printf("ROW: %s\n", line.c_str());
-// printf("Columns: %ld\n", (long) vec.size());
-// for( size_t i = 0; i < vec.size(); ++i) printf("%ld: |%s|\n", (long) i, vec[i].c_str());
+// printf("Columns: %ld\n", (long) row.fields());
 // printf("**************************************\n");
 // #endif
 
 			// add parsed line back to table storage
-			storage.push_back(vec);
-			++act_rows;
-			// show an update every 25,000 rows in the status bar – very expensive!
-			if( act_rows % 25000 == 0 ) {
-				sstr.clear();
-				sstr.str("");
-				sstr << "Parsed " << act_rows << " lines.";
-				#ifndef TCRUNCHER_PARSER_WITHOUT_UPDATE
-				windows[app.getTopWindow()].updateStatusbar(sstr.str());
-				#endif
-			}
-			if( maxLines && act_rows >= maxLines) {
+			storage.push_back(row);
+			if( maxLines && progress.rows >= maxLines) {
 				break;
 			}
+			if( publishRows && progress.rows % TCRUNCHER_PARSER_PUBLISH_ROWS == 0 ) {
+				progress.bytes = (size_t) std::max<std::streamoff>(0, input->rdbuf()->pubseekoff(0, std::ios::cur, std::ios::in));
+				if( !publishRows(storage, progress, false) ) {
+					break;
+				}
+			}
 		}
 		// stop parsing if input has been fully consumed
 		if( input->rdstate() == std::ios_base::eofbit )
 			break;
 	} // end of while( myGetlineEncodings() )
+	progress.bytes = (size_t) std::max<std::streamoff>(progress.bytes, input->rdbuf()->pubseekoff(0, std::ios::cur, std::ios::in));
+}
 
-	// Delete last row if storage is not empty
-	if( storage.rows() )
-		storage.deleteRows( storage.rows() - 1, storage.rows() - 1 );
-	
-	// #ifdef DEBUG
-	// printf("rowLengths: %zu\n", rowLengths.size());
-	// for( auto const & kv : rowLengths) {
-	// 	printf("Length %ld: %ld\n", kv.first, kv.second);
-	// }
-	// #endif
-	
-	return rowLengths;
+
+/*
+	Parses the whole stream in batches of lines. The lines of a batch are split into one chunk per thread and every
+	chunk is parsed on the assumption that it starts outside of quotes. The chunks are then appended in order,
+	carrying the state of the parser from chunk to chunk. If a chunk actually starts within a quoted field, its
+	lines are parsed again until both parses end a line outside of quotes – from there on the rows are the same.
+	While a batch gets parsed, the next one is read. The first batch is small, so the first rows are
+	published early – see parseCsvSegments().
+
+	The rows and their histogram are exactly the ones of the sequential loop in parseCsvStream(), including the
+	empty line that loop reads at the end of the stream. Afterwards the stream's eofbit is set like that loop does.
+ */
+void CsvParser::parseCsvParallel(std::istream *input, LineReader &reader, CsvDataStorage &storage, CsvDefinition *definition, bool resizeRows, Progress &progress) {
+	LineBatch batches[2];
+	CsvDataStorage::RowBuffer row;
+	size_t current = 0;
+	size_t batchBytes = TCRUNCHER_PARSER_FIRST_BATCH_BYTES;
+	bool stopped = false;
+
+	readBatch(reader, batches[current], batchBytes);
+	for(;;) {
+		LineBatch &batch = batches[current];
+		std::thread readAhead;
+		if( !batch.eof ) {
+			batchBytes = std::min(batchBytes * 2, TCRUNCHER_PARSER_BATCH_BYTES);
+			readAhead = std::thread(readBatch, std::ref(reader), std::ref(batches[1 - current]), batchBytes);
+		}
+		size_t lines = batch.ends.size();
+		size_t numChunks = Helper::parallelChunks(lines, TCRUNCHER_PARSER_MIN_CHUNK_LINES);
+		std::vector<Chunk> chunks(numChunks);
+		Helper::parallelFor(lines, TCRUNCHER_PARSER_MIN_CHUNK_LINES, [&](size_t chunk, size_t from, size_t to) {
+			parseChunk(batch, from, to, definition, chunks[chunk]);
+		});
+		for( size_t chunk = 0; chunk < numChunks; ++chunk ) {
+			appendChunk(batch, lines * chunk / numChunks, lines * (chunk + 1) / numChunks, chunks[chunk], row, storage, definition, resizeRows, progress);
+		}
+		progress.bytes += batch.bytes();
+		if( publishRows && !batch.eof ) {
+			stopped = !publishRows(storage, progress, false);
+		}
+		if( readAhead.joinable() ) {
+			readAhead.join();
+		}
+		if( batch.eof || stopped ) {
+			break;
+		}
+		current = 1 - current;
+	}
+
+	// the empty line at the end of the stream
+	if( !stopped ) {
+		std::string line;
+		parseCsvLine(row, line, definition);
+		if( parseCsvState == CSVPARSER_CONST_NOT_ENCLOSED ) {
+			countRow(progress, storage, row.fields(), false, resizeRows);
+			storage.push_back(row);
+		}
+	}
+	input->setstate(std::ios::eofbit);
+}
+
+
+/*
+	Reads lines into `batch` until it holds `batchBytes` or the stream is exhausted
+ */
+void CsvParser::readBatch(LineReader &reader, LineBatch &batch, size_t batchBytes) {
+	batch.text.clear();
+	batch.ends.clear();
+	while( batch.text.size() < batchBytes ) {
+		if( !reader.appendLine(batch.text) ) {
+			batch.eof = true;
+			break;
+		}
+		batch.ends.push_back(batch.text.size());
+	}
+}
+
+
+/*
+	Parses the lines [from, to) of `batch` into `chunk`, starting outside of quotes. Runs on a thread of its own.
+ */
+void CsvParser::parseChunk(const LineBatch &batch, size_t from, size_t to, CsvDefinition *definition, Chunk &chunk) {
+	CsvParser parser;
+	std::string line;
+	chunk.endsEnclosed.reserve(to - from);
+	for( size_t i = from; i < to; ++i ) {
+		batch.line(i, line);
+		translateEncoding(line, definition);
+		parser.parseCsvLine(chunk.row, line, definition);
+		chunk.endsEnclosed.push_back(parser.parseCsvState == CSVPARSER_CONST_ENCLOSED);
+		if( parser.parseCsvState == CSVPARSER_CONST_NOT_ENCLOSED ) {
+			chunk.rows.push_back(chunk.row);
+		}
+	}
+	chunk.rows.shrink();
+	chunk.state = parser.parseCsvState;
+}
+
+
+/*
+	Appends the rows of `chunk`, which holds the lines [from, to) of `batch`, to `storage` and takes over the
+	parser state after its last line. `row` holds the incomplete row.
+ */
+void CsvParser::appendChunk(const LineBatch &batch, size_t from, size_t to, Chunk &chunk, CsvDataStorage::RowBuffer &row, CsvDataStorage &storage, CsvDefinition *definition, bool resizeRows, Progress &progress) {
+	size_t skip = 0;				// rows of the chunk that have been parsed again
+	if( parseCsvState == CSVPARSER_CONST_ENCLOSED ) {
+		// the chunk starts within quotes: parse again until both parses end a line outside of quotes
+		std::string line;
+		bool converged = false;
+		for( size_t i = from; i < to && !converged; ++i ) {
+			batch.line(i, line);
+			translateEncoding(line, definition);
+			parseCsvLine(row, line, definition);
+			if( parseCsvState == CSVPARSER_CONST_NOT_ENCLOSED ) {
+				countRow(progress, storage, row.fields(), true, resizeRows);
+				storage.push_back(row);
+			}
+			if( !chunk.endsEnclosed[i - from] ) {
+				++skip;
+				converged = parseCsvState == CSVPARSER_CONST_NOT_ENCLOSED;
+			}
+		}
+		if( !converged ) {
+			// all lines have been parsed again
+			return;
+		}
+	}
+	for( size_t r = skip; r < chunk.rows.size(); ++r ) {
+		countRow(progress, storage, chunk.rows.fields(r), true, resizeRows);
+	}
+	storage.append(chunk.rows, skip);
+	parseCsvState = chunk.state;
+	std::swap(row, chunk.row);
+}
+
+
+/*
+	Accounts a parsed row with `fields` fields before it gets stored: records its length in the histogram (if
+	`record`) and widens the storage if necessary.
+ */
+void CsvParser::countRow(Progress &progress, CsvDataStorage &storage, size_t fields, bool record, bool resizeRows) {
+	if( record ) {
+		progress.rowLengths[fields]++;
+	}
+	// resize rows
+	// shorter rows are stored as they are, the storage treats their missing fields as empty
+	if( resizeRows && progress.columns < (table_index_t) fields ) {
+		// parsed line is longer than columns(): resize storage – this doesn't touch the rows already stored
+		storage.resize(0, (table_index_t) fields);
+		progress.columns = (table_index_t) fields;
+	}
+	++progress.rows;
+}
+
+
+/*
+	Translates `line` from the encoding of `definition` to valid UTF-8
+ */
+void CsvParser::translateEncoding(std::string &line, CsvDefinition *definition) {
+	switch( definition->encoding ) {
+		case CsvDefinition::ENC_NONE:
+		case CsvDefinition::ENC_UTF8:
+			Helper::fixUtf8(line);				// replaces invalid chars with replacement char
+		break;
+		case CsvDefinition::ENC_Latin1:
+			line = Helper::latin1toutf8(line);
+		break;
+		case CsvDefinition::ENC_Win1252:
+			line = Helper::win1252toutf8(line);
+		break;
+		case CsvDefinition::ENC_UTF16LE:			// translation happens in myGetlineEncodings()
+		case CsvDefinition::ENC_UTF16BE:			// translation happens in myGetlineEncodings()
+		default:
+		break;
+	}
 }
 
 
@@ -167,24 +361,36 @@ std::map<long,long> CsvParser::parseCsvStream( std::istream *input, CsvDataStora
  	Expects 'line' to be in UTF8.
 
  */
-void CsvParser::parseCsvLine(std::vector<std::string>& vector, const std::string &line, CsvDefinition *definition) {
+void CsvParser::parseCsvLine(CsvDataStorage::RowBuffer &row, const std::string &line, CsvDefinition *definition) {
 	bool enclosed = false;				// true: Falls wir innerhalb von Quotes sind
 	bool startField = true;				// true: immer zu Beginn eines Feldes
 
 	long lineLen = line.size();
-	std::string real_field = "";
+	std::string &real_field = row.data;	// the current field is always the end of the row
 	
 	if( parseCsvState == CSVPARSER_CONST_ENCLOSED ) {
+		// the quoted field of the previous line continues, it's still at the end of `row`
 		enclosed = true;
-		real_field = parseCsvRemaining + "\n";		// LF "\n" is the right thing to do, as CRLF "\r\n" would be shown as "^M" in CODE_INPUT_WIDGET TODO doesn't this change inlne "\r\n" to "\n"??
+		real_field.push_back('\n');		// LF "\n" is the right thing to do, as CRLF "\r\n" would be shown as "^M" in CODE_INPUT_WIDGET TODO doesn't this change inlne "\r\n" to "\n"??
 	} else {
-		vector.clear();			
+		row.clear();
 	}
 
-	real_field.reserve(10000);			// reserve 10kb to increase parsing performance: boosts performance by factor of 4
+	structuralIndex.scan(line.data(), lineLen, definition->delimiter, definition->quote, definition->escape);
 
 	for( long i = 0; i < lineLen; i++ ) {
 
+		// everything up to the next delimiter, quote or escape character is field content: copy it at once
+		long next = (long) structuralIndex.next(i, enclosed);
+		if( next > i ) {
+			startField = false;
+			real_field.append(line, i, next - i);
+			i = next;
+			if( i == lineLen ) {
+				break;
+			}
+		}
+
 // #ifdef DEBUG
 // printf("  Char: %c", line[i]);
 // if( enclosed ) printf(" (enclosed)");
@@ -235,9 +441,8 @@ void CsvParser::parseCsvLine(std::vector<std::string>& vector, const std::string
 
 
 		if( line[i] == definition->delimiter && !enclosed ) {
-			// Zeichen ist ein Seperator und wir sind nicht quotiert: aktuelles Feld zurückschreiben
-			vector.push_back( real_field );
-			real_field = "";
+			// Zeichen ist ein Seperator und wir sind nicht quotiert: aktuelles Feld abschließen
+			row.endField();
 			enclosed = false;
 			startField = true;
 			continue;
@@ -248,13 +453,11 @@ void CsvParser::parseCsvLine(std::vector<std::string>& vector, const std::string
 	}	// END for
 
 	if( !enclosed ) {
-		// Zeile abgearbeitet und wir sind nicht mehr quotiert: aktuelles Feld zurückschreiben
-		vector.push_back( real_field );
+		// Zeile abgearbeitet und wir sind nicht mehr quotiert: die Zeile ist vollständig
 		parseCsvState = CSVPARSER_CONST_NOT_ENCLOSED;
 	} else {
 		// wir sind am Zeilenende quotiert!? neue Zeile quotiert beginnen und Zeile noch nicht an storage anhängen
 		parseCsvState = CSVPARSER_CONST_ENCLOSED;
-		parseCsvRemaining = real_field;
 	}
 
 }
@@ -268,36 +471,16 @@ void CsvParser::parseCsvLine(std::vector<std::string>& vector, const std::string
 
 	Used by myGetlineEncodings()
 
-	http://stackoverflow.com/questions/6089231/getting-std-ifstream-to-handle-lf-cr-and-crlf
+	Handles LF, CR and CRLF line endings and skips NUL bytes, see `LineReader`.
 	Just works for ASCII-based 8-bit encodings like ASCII, Latin1, Latin9, Win1252 and UTF8
  */
-std::istream& CsvParser::myGetline(std::istream& is, std::string& t) {
-	t.clear();
-
-    std::istream::sentry se(is, true);
-    std::streambuf* sb = is.rdbuf();
-
-    for(;;) {
-        int c = sb->sbumpc();
-        switch (c) {
-        case '\n':
-            return is;
-        case '\r':
-            if(sb->sgetc() == '\n')
-                sb->sbumpc();
-            return is;
-        case EOF:
-            // Also handle the case when the last line has no line ending
-            if(t.empty())
-                is.setstate(std::ios::eofbit);
-            return is;
-		case '\0':
-			// skip NULL bytes
-			break;
-        default:
-            t += (char)c;
-        }
-    }
+std::istream& CsvParser::myGetline(std::istream& is, LineReader &reader, std::string& t) {
+	std::istream::sentry se(is, true);
+	if( !reader.getline(t) ) {
+		// nothing left – a last line without line ending has still been returned
+		is.setstate(std::ios::eofbit);
+	}
+	return is;
 }
 
 
@@ -306,13 +489,13 @@ std::istream& CsvParser::myGetline(std::istream& is, std::string& t) {
  *	https://stackoverflow.com/a/50714844/2771733
  *	TODO UTF-32LE and UTF-32BE
  */
-std::istream& CsvParser::myGetlineEncodings(std::istream& is, std::string& t, CsvDefinition::Encodings enc) {
+std::istream& CsvParser::myGetlineEncodings(std::istream& is, LineReader &reader, std::string& t, CsvDefinition::Encodings enc) {
 	if( enc == CsvDefinition::ENC_UTF8 ||
 		enc == CsvDefinition::ENC_Latin1 ||
 		enc == CsvDefinition::ENC_Latin9 ||
 		enc == CsvDefinition::ENC_Win1252
 	 ) {
-		return myGetline(is, t);
+		return myGetline(is, reader, t);
 	}
 	codeUnitReturn_t nextCodeUnit;
 	int unitLength = 1;
@@ -28,6 +28,9 @@
 #include <string>
 #include <vector>
 #include <tuple>
+#include <map>
+#include <thread>
+#include <functional>
 #include <istream>
 #include <cstdint>
 #include <inttypes.h>
@@ -40,11 +43,8 @@
 #include "helper.hh"
 #include "globals.hh"
 #include "csvdatastorage.hh"
-
-#ifndef TCRUNCHER_PARSER_WITHOUT_UPDATE
-#include "csvapplication.hh"
-#include "csvwindow.hh"
-#endif
+#include "linereader.hh"
+#include "structuralindex.hh"
 
 
 #define CSVPARSER_CONST_ENCLOSED 1
@@ -57,6 +57,7 @@
  * \brief The custom CSV parser class.
  * 
  * Implements a finite state machine to parse the CSV data provided by a `std::istream` object.
+ * The machine only steps through delimiters, quotes and escape characters, found by `StructuralIndex`.
  * 
  */
 class CsvParser {
@@ -67,15 +68,53 @@ class CsvParser {
 			uint32_t codeUnit32;
 		};
 	} codeUnitReturn_t;
+	// bookkeeping of a parseCsvStream() call
+	struct Progress {
+		table_index_t rows = 0;									// rows stored so far
+		table_index_t columns = 0;								// length of the longest row stored so far, if resizing
+		std::map<table_index_t,table_index_t> rowLengths;		// histogram of the row lengths
+		size_t bytes = 0;										// bytes of the stream parsed so far, roughly
+	};
+	// lines read ahead to be parsed in parallel
+	struct LineBatch {
+		std::string text;										// the lines without their line endings
+		std::vector<size_t> ends;								// end of every line within `text`, line i starts at ends[i-1]
+		bool eof = false;										// true if the stream is exhausted after these lines
+		size_t bytes() const { return text.size() + ends.size(); }	// bytes of the lines, one byte per line ending
+		void line(size_t i, std::string &t) const { size_t begin = i ? ends[i - 1] : 0; t.assign(text, begin, ends[i] - begin); }
+	};
+	// the rows of a range of lines, parsed on the assumption that the range starts outside of quotes
+	struct Chunk {
+		CsvDataStorage::Segment rows;							// the rows completed within the range
+		std::vector<bool> endsEnclosed;							// for every line: true if it ends within quotes
+		int state = CSVPARSER_CONST_NOT_ENCLOSED;				// parseCsvState after the last line
+		CsvDataStorage::RowBuffer row;							// the incomplete row after the last line
+	};
 public:
-	std::map<long,long> parseCsvStream( std::istream *input, CsvDataStorage &storage, CsvDefinition *definition, int maxLines=0, bool resizeRows=true );
+	typedef std::function<bool(CsvDataStorage::Segment &rows, table_index_t columns, size_t bytes, bool complete)> SegmentHandler;
+	std::map<table_index_t,table_index_t> parseCsvStream( std::istream *input, CsvDataStorage &storage, CsvDefinition *definition, int maxLines=0, bool resizeRows=true );
+	std::map<table_index_t,table_index_t> parseCsvSegments( std::istream *input, CsvDefinition *definition, const SegmentHandler &handler );
+	static void finishStorage(CsvDataStorage &storage, bool encode=true);
 private:
+	static constexpr size_t TCRUNCHER_PARSER_FIRST_BATCH_BYTES = 1024 * 1024;	// bytes read ahead for the first batch, the following ones double in size
+	static constexpr size_t TCRUNCHER_PARSER_BATCH_BYTES = 32 * 1024 * 1024;	// bytes read ahead for parsing in parallel
+	static constexpr table_index_t TCRUNCHER_PARSER_PUBLISH_ROWS = 50000;		// rows between two publishRows() calls when parsing sequentially
+	static constexpr size_t TCRUNCHER_PARSER_MIN_CHUNK_LINES = 10000;			// lines parsed by a single thread at least
+
 	int parseCsvState = CSVPARSER_CONST_NOT_ENCLOSED;
-	std::string parseCsvRemaining = "";
+	StructuralIndex structuralIndex;			// positions of delimiters, quotes and escapes in the line being parsed
+	std::function<bool(CsvDataStorage &, const Progress &, bool)> publishRows;	// set by parseCsvSegments(): hands the stored rows over, false stops parsing
 	
-	void parseCsvLine(std::vector<std::string>& vector, const std::string &line, CsvDefinition *definition);
-	static std::istream& myGetline(std::istream& is, std::string& t);
-	static std::istream& myGetlineEncodings(std::istream& is, std::string& t, CsvDefinition::Encodings enc);
+	void parseRows(std::istream *input, CsvDataStorage &storage, CsvDefinition *definition, int maxLines, bool resizeRows, Progress &progress);
+	void parseCsvParallel(std::istream *input, LineReader &reader, CsvDataStorage &storage, CsvDefinition *definition, bool resizeRows, Progress &progress);
+	static void readBatch(LineReader &reader, LineBatch &batch, size_t batchBytes);
+	static void parseChunk(const LineBatch &batch, size_t from, size_t to, CsvDefinition *definition, Chunk &chunk);
+	void appendChunk(const LineBatch &batch, size_t from, size_t to, Chunk &chunk, CsvDataStorage::RowBuffer &row, CsvDataStorage &storage, CsvDefinition *definition, bool resizeRows, Progress &progress);
+	void countRow(Progress &progress, CsvDataStorage &storage, size_t fields, bool record, bool resizeRows);
+	static void translateEncoding(std::string &line, CsvDefinition *definition);
+	void parseCsvLine(CsvDataStorage::RowBuffer &row, const std::string &line, CsvDefinition *definition);
+	static std::istream& myGetline(std::istream& is, LineReader &reader, std::string& t);
+	static std::istream& myGetlineEncodings(std::istream& is, LineReader &reader, std::string& t, CsvDefinition::Encodings enc);
 	static codeUnitReturn_t getNextCodeUnit(std::streambuf *sb, int unitLength, bool bigEndian=true);
 };
 
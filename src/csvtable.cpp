@@ -53,6 +53,7 @@ CsvTable::CsvTable(const CsvTable &table) {
 	size_t size;
 	
 	this->storage = table.storage;
+	this->rowOrder = table.rowOrder;
 	size = table.headerRow->size();
 	this->headerRow = new std::vector<std::string>();
 	this->headerRow->resize(size);
@@ -103,16 +104,25 @@ std::string CsvTable::getHeaderCell(table_index_t c, bool returnEmpty) {
 
 std::string CsvTable::getCell(table_index_t row, table_index_t col) {
 	if( row >= 0 and row < storage.rows() and col >= 0 and col <= storage.columns() ) {
-		return storage.get(row,col);
+		return storage.get(storageRow(row),col);
 	} else {
 		return "";
 	}
 }
 
 
+/*
+ *	Returns a view of the cell content without copying it.
+ *	The view is only valid until the table gets modified.
+ */
+std::string_view CsvTable::getCellView(table_index_t row, table_index_t col) {
+	return storage.getView(storageRow(row),col);
+}
+
+
 void CsvTable::setCell(std::string content, table_index_t row, table_index_t col) {
 	if( row >= 0 and row < getNumberRows() and col >= 0 and col <= getNumberCols() ) {
-		storage.set(content, row, col);
+		storage.set(content, storageRow(row), col);
 	} else {
 		// TODO Handle error
 	}
@@ -130,7 +140,7 @@ std::vector< std::vector<std::string> > CsvTable::copyBlock(table_index_t row_to
 	
 	for( rows = row_top; rows <= row_bot; ++rows ) {
 		for( cols = col_top; cols <= col_bot; ++cols ) {
-			line.push_back( storage.get(rows,cols) );
+			line.push_back( storage.get(storageRow(rows),cols) );
 		}
 		block.push_back( line );
 		line.clear();
@@ -145,7 +155,7 @@ std::vector< std::vector<std::string> > CsvTable::copyBlock(table_index_t row_to
 	Return R-th row
  */
 std::vector<std::string> CsvTable::row(table_index_t R) {
-	return storage.row(R);
+	return storage.row(storageRow(R));
 }
 
 
@@ -153,6 +163,7 @@ std::vector<std::string> CsvTable::row(table_index_t R) {
  *	Adds an empty row after (or before) the given rowNr
  */
 void CsvTable::addRow(table_index_t rowNr, bool before) {
+	materializeRowOrder();
 	if( rowNr >= storage.rows() )
 		rowNr = storage.rows() - 1;
 	if( rowNr < 0 )
@@ -194,6 +205,20 @@ void CsvTable::addCol(table_index_t colNr, bool before) {
 
 
 
+/**
+ *	Inserts the given rows before rowNr, or appends them if rowNr is getNumberRows() – used by undo
+ */
+void CsvTable::insertRows(table_index_t rowNr, const std::vector< std::vector<std::string> > &rows) {
+	if( rowNr < 0 || rowNr > storage.rows() || rows.empty() )
+		return;
+	materializeRowOrder();
+	storage.insertRows(rowNr, rows);
+	moveFlags(rowNr, (table_index_t) rows.size());
+	updateInternals();
+}
+
+
+
 void CsvTable::delRows(table_index_t rowFrom, table_index_t rowTo, bool clearFlags, bool doUpdateInternals ) {
 	table_index_t numToDel = rowTo - rowFrom + 1;
 	if( numToDel >= storage.rows() )				// don't delete, if all rows are to be deleted
@@ -201,15 +226,11 @@ void CsvTable::delRows(table_index_t rowFrom, table_index_t rowTo, bool clearFla
 	if( rowFrom < 0 || rowTo < 0 || rowFrom >= storage.rows() || rowTo >= storage.rows() )		// don't delete if row range is not valid
 		return;
 
+	materializeRowOrder();
 	storage.deleteRows(rowFrom, rowTo);
 
 	// erase flags from rows that are deleted
 	if( clearFlags ) {
-		for( table_index_t r = rowFrom; r <= rowTo; ++r ) {
-			if( flags.find(r) != flags.end() ) {
-				flags.erase(r);
-			}
-		}
 		moveFlags(rowFrom, -numToDel);
 	}
 	if( doUpdateInternals ) {
@@ -231,6 +252,33 @@ void CsvTable::delCols(table_index_t colFrom, table_index_t colTo) {
 }
 
 
+/*
+ *	Returns all cells of a column in table order
+ */
+std::vector<std::string> CsvTable::columnCells(table_index_t col) {
+	std::vector<std::string> cells;
+	table_index_t R = getNumberRows();
+	cells.reserve(R);
+	for( table_index_t r = 0; r < R; ++r ) {
+		cells.push_back( getCell(r, col) );
+	}
+	return cells;
+}
+
+
+/*
+ *	Sets the cells of a column from the first row on, as returned by columnCells()
+ */
+void CsvTable::setColumnCells(table_index_t col, const std::vector<std::string> &cells) {
+	table_index_t R = std::min( getNumberRows(), (table_index_t) cells.size() );
+	for( table_index_t r = 0; r < R; ++r ) {
+		if( getCellView(r, col) != cells[r] ) {
+			setCell(cells[r], r, col);
+		}
+	}
+}
+
+
 /*
  *	Move columns right or left
  */
@@ -289,7 +337,7 @@ std::tuple<table_index_t, table_index_t> CsvTable::findSubstring(std::string sea
 		// if( std::get<0>(executeReturn) == -1 ) {
 		// 	printf("ERROR: %s\n", std::get<1>(executeReturn).c_str());
 		// }
-		std::vector<int> result = Macro::getLastResultInts();
+		std::vector<table_index_t> result = Macro::getLastResultInts();
 		if( result.size() == 2 ) {
 			return std::make_tuple(result[0], result[1]);
 		}
@@ -312,19 +360,21 @@ std::tuple<table_index_t, table_index_t> CsvTable::findSubstring(std::string sea
 	startCol = c;
 	// start searching ...
 	cnt = 0;
+	// the row string doesn't contain the values of encoded columns, so it can't be used as a filter then
+	bool rowFilter = !storage.hasEncodedColumns();
 	// TODO Avoid multiple searches in the same row (to improve performance)
 	do {
 		if( caseSensitive ) {
 			if(
-				storage.getRow(r).find(search) != std::string::npos &&		// first search in rows – only if matching, search in cell
-				getCell(r,c).find(search) != std::string::npos
+				(!rowFilter || storage.rowView(storageRow(r)).find(search) != std::string_view::npos) &&		// first search in rows – only if matching, search in cell
+				getCellView(r,c).find(search) != std::string_view::npos
 			) {
 				return std::make_tuple(r, c);
 			}
 		} else {
 			if(
-				Utf8CppUtils::utf8::casefold(storage.getRow(r)).find(lowerSearch) != std::string::npos &&
-				Utf8CppUtils::utf8::casefold(getCell(r,c)).find(lowerSearch) != std::string::npos
+				(!rowFilter || Utf8CppUtils::utf8::casefold(std::string(storage.rowView(storageRow(r)))).find(lowerSearch) != std::string::npos) &&
+				Utf8CppUtils::utf8::casefold(std::string(getCellView(r,c))).find(lowerSearch) != std::string::npos
 			) {
 				return std::make_tuple(r, c);
 			}
@@ -406,7 +456,7 @@ bool CsvTable::findInCell(std::string search, table_index_t r, table_index_t c,
 		if( std::get<0>(executeReturn) == -1 ) {
 			printf("ERROR: %s\n", std::get<1>(executeReturn).c_str());
 		}
-		std::vector<int> found = Macro::getLastResultInts();
+		std::vector<table_index_t> found = Macro::getLastResultInts();
 		if( found.size() == 1 && found.at(0) == 1 ) {
 			return true;
 		}
@@ -416,17 +466,18 @@ bool CsvTable::findInCell(std::string search, table_index_t r, table_index_t c,
 	if( !caseSensitive ) {
 		lowerSearch = Utf8CppUtils::utf8::casefold(search);
 	}
+	bool rowFilter = !storage.hasEncodedColumns();		// see findSubstring()
 	if( caseSensitive ) {
 		if(
-			storage.getRow(r).find(search) != std::string::npos &&
-			getCell(r,c).find(search) != std::string::npos
+			(!rowFilter || storage.rowView(storageRow(r)).find(search) != std::string_view::npos) &&
+			getCellView(r,c).find(search) != std::string_view::npos
 		) {
 			return true;
 		}
 	} else {
 		if(
-			Utf8CppUtils::utf8::casefold(storage.getRow(r)).find(lowerSearch) != std::string::npos &&
-			Utf8CppUtils::utf8::casefold(getCell(r,c)).find(lowerSearch) != std::string::npos
+			(!rowFilter || Utf8CppUtils::utf8::casefold(std::string(storage.rowView(storageRow(r)))).find(lowerSearch) != std::string::npos) &&
+			Utf8CppUtils::utf8::casefold(std::string(getCellView(r,c))).find(lowerSearch) != std::string::npos
 		) {
 			return true;
 		}
@@ -509,7 +560,7 @@ std::tuple<std::string, int> CsvTable::replaceUtf8String(std::string pattern, st
 			printf("ERROR: %s\n", std::get<1>(executeReturn).c_str());
 		}
 		std::vector<std::string> changedStr = Macro::getLastResultStrings();
-		std::vector<int> changes = Macro::getLastResultInts();
+		std::vector<table_index_t> changes = Macro::getLastResultInts();
 		if( changedStr.size() == 1 ) {
 			return std::make_tuple(changedStr[0], changes[0]);
 		}
@@ -545,6 +596,7 @@ void CsvTable::dumpStatus(std::string msg) {
 
 void CsvTable::clearTable() {
 	storage.clear();
+	rowOrder.clear();
 	flags.clear();
 	updateInternals();
 }
@@ -555,6 +607,9 @@ void CsvTable::clearTable() {
  *	Resizes table so that it matches new_rows, new_cols.
  */
 void CsvTable::resizeTable(table_index_t new_rows, table_index_t new_cols) {
+	if( new_rows != storage.rows() ) {
+		materializeRowOrder();
+	}
 	storage.resize(new_rows, new_cols);
 	updateInternals();
 }
@@ -627,6 +682,7 @@ int CsvTable::switchHeader() {
 	if( storage.rows() <= 1 && hasCustomHeaderRow == false) {
 		return 0;
 	}
+	materializeRowOrder();
 	
 	if( hasCustomHeaderRow ) {
 		// Custom Headers => Default Headers
@@ -695,6 +751,7 @@ int CsvTable::saveCsv(std::string path, void (*cb)(const char*, void *), void *w
 	std::string tempStr;
 	int retCode = 0;
 	std::ofstream output(path, std::ios::binary);
+	std::vector<std::string_view> rowViews;
 	
 	// rather stupid TODO fix when `headerRow` gets fixed
 	std::vector<std::string> headerRowCopy;
@@ -729,10 +786,15 @@ int CsvTable::saveCsv(std::string path, void (*cb)(const char*, void *), void *w
 		}
 		for( table_index_t r = rowStart; r < rowEnd; ++r ) {
 			if( !flaggedOnly || isFlagged(r) ) {
-				output << encode( vec2string(storage.row(r), definition), definition.encoding );
+				rowViews.clear();
+				// getView() resolves the column order of the storage, so moved columns are written without rewriting the storage first
+				for( table_index_t c = 0; c < storage.columns(); ++c ) {
+					rowViews.push_back( storage.getView(storageRow(r),c) );
+				}
+				output << encode( vec2string(rowViews, definition), definition.encoding );
 				output << encode( definition.linebreak, definition.encoding );
 				if( (r % 20000) == 0 ) {
-					snprintf(msg, MAX_MSG_LEN, "Saved %d lines to file.", r);
+					snprintf(msg, MAX_MSG_LEN, "Saved %lld lines to file.", (long long) r);
 					cb(msg, win);
 				}
 			}
@@ -761,11 +823,40 @@ int CsvTable::exportJSON(std::string path, void (*cb)(const char*, void *), void
 	const int MAX_MSG_LEN = 500;
 	char msg[MAX_MSG_LEN + 1];
 	std::map<std::string, std::string> item;
+	std::vector<const NumericColumn *> numbers;
 	Helper::parseNumberStruct parsedNum;
+	std::string cell;
 	
 	if( output ) {
 		rowCount = storage.rows();
 		colCount = storage.columns();
+		if( convertNumbers ) {
+			// columns that have already been parsed (e.g. for sorting) aren't parsed again – caching all
+			// columns just for the export would need 8 bytes per cell
+			for( table_index_t c = 0; c < colCount; ++c ) {
+				numbers.push_back( storage.cachedNumbers(c) );
+			}
+		}
+		// a cell as JSON value: a number if it looks like one and convertNumbers is set, a string otherwise
+		auto jsonValue = [&](table_index_t row, table_index_t c) -> nlohmann::json {
+			table_index_t i = storageRow(row);
+			if( convertNumbers && numbers[c] ) {
+				if( numbers[c]->isInteger(i) ) {
+					return numbers[c]->integerAt(i);
+				} else if( numbers[c]->isNumber(i) ) {
+					return numbers[c]->realAt(i);
+				}
+			} else if( convertNumbers ) {
+				parsedNum = Helper::parseNumber( storage.getView(i,c) );
+				if( parsedNum.myType == Helper::parseNumberType::INT ) {
+					return parsedNum.myInteger;
+				} else if( parsedNum.myType == Helper::parseNumberType::FLOAT ) {
+					return parsedNum.myFloat;
+				}
+			}
+			cell.assign( storage.getView(i,c) );
+			return cell;
+		};
 		output.clear();
 		nlohmann::json json;
 		output << "[";
@@ -773,34 +864,12 @@ int CsvTable::exportJSON(std::string path, void (*cb)(const char*, void *), void
 			json.clear();
 			if( hasCustomHeaderRow ) {
 				for (table_index_t c = 0; c < colCount; ++c) {
-					if( convertNumbers ) {
-						parsedNum = Helper::parseNumber( getCell(i,c) );
-						if( parsedNum.myType == Helper::parseNumberType::INT ) {
-							json[headerRow->at(c)] = parsedNum.myInteger;
-						} else if( parsedNum.myType == Helper::parseNumberType::FLOAT ) {
-							json[headerRow->at(c)] = parsedNum.myFloat;
-						} else {
-							json[headerRow->at(c)] = getCell(i,c);
-						}
-					} else {
-						json[headerRow->at(c)] = getCell(i,c);
-					}
+					json[headerRow->at(c)] = jsonValue(i, c);
 				}
 				output << json.dump();
 			} else {
 				for (table_index_t c = 0; c < colCount; ++c) {
-					if( convertNumbers ) {
-						parsedNum = Helper::parseNumber( getCell(i,c) );
-						if( parsedNum.myType == Helper::parseNumberType::INT ) {
-							json.push_back( parsedNum.myInteger );
-						} else if( parsedNum.myType == Helper::parseNumberType::FLOAT ) {
-							json.push_back( parsedNum.myFloat );
-						} else {
-							json.push_back(getCell(i,c));
-						}
-					} else {
-						json.push_back(getCell(i,c));
-					}
+					json.push_back( jsonValue(i, c) );
 				}
 				output << json.dump();
 			}
@@ -809,7 +878,7 @@ int CsvTable::exportJSON(std::string path, void (*cb)(const char*, void *), void
 			}
 			output << ",";
 			if( (i % 20000) == 0 ) {
-				snprintf(msg, MAX_MSG_LEN, "Saved %d lines to file.", i);
+				snprintf(msg, MAX_MSG_LEN, "Saved %lld lines to file.", (long long) i);
 				cb(msg, win);
 			}
 		}	// for
@@ -825,10 +894,71 @@ int CsvTable::exportJSON(std::string path, void (*cb)(const char*, void *), void
 
 
 /*
- *	sortType 0:Numerical, 1:String, 2:String (ignore case) – default: 1
+ *	sortType 0:Numerical, 1:String, 2:String (ignore case), 3:Natural – default: 1
+ *	backend: comparison or radix sort – AUTO chooses by the number of rows
+ */
+void CsvTable::sortTable(table_index_t column, bool ascending, int sortType, CsvDataStorage::SortBackend backend) {
+	sortTable( std::vector<CsvDataStorage::SortColumn>{ {column, ascending, sortType} }, backend );
+}
+
+
+/*
+ *	Stable sort by several columns, the first one has precedence.
+ *	Only the row order of the table is changed, the storage keeps its order (see materializeRowOrder()).
+ *	Rows that are equal in all sort columns keep the order they are shown in.
+ */
+void CsvTable::sortTable(const std::vector<CsvDataStorage::SortColumn> &sortColumns, CsvDataStorage::SortBackend backend) {
+	std::vector<table_index_t> order = storage.sortedOrder(sortColumns, backend, rowOrder);
+	if( !order.empty() ) {
+		rowOrder = std::move(order);
+	}
+}
+
+
+/*
+ *	Returns true if the rows are shown in a sorted order that hasn't been applied to the storage
  */
-void CsvTable::sortTable(table_index_t column, bool ascending, int sortType) {
-	storage.sort(column, ascending, sortType);
+bool CsvTable::isSortedView() {
+	return !rowOrder.empty();
+}
+
+
+/*
+ *	Returns the storage row of every table row – empty if the rows are shown in storage order
+ */
+const std::vector<table_index_t> &CsvTable::getRowOrder() {
+	return rowOrder;
+}
+
+
+/*
+ *	Sets the row order, e.g. when undoing a sort. `order` has to be empty or a permutation of all rows.
+ */
+void CsvTable::setRowOrder(const std::vector<table_index_t> &order) {
+	if( order.empty() || (table_index_t) order.size() == storage.rows() ) {
+		rowOrder = order;
+	}
+}
+
+
+/*
+ *	Returns the storage row that is shown as table row R
+ */
+table_index_t CsvTable::storageRow(table_index_t R) {
+	return rowOrder.empty() || R < 0 || R >= (table_index_t) rowOrder.size() ? R : rowOrder[R];
+}
+
+
+/*
+ *	Applies the sorted row order to the storage, so table rows and storage rows are the same again.
+ *	Called by all operations that insert or delete rows.
+ */
+void CsvTable::materializeRowOrder() {
+	if( !rowOrder.empty() ) {
+		storage.reorder(rowOrder);
+		rowOrder.clear();
+		rowOrder.shrink_to_fit();
+	}
 }
 
 
@@ -872,8 +1002,9 @@ void CsvTable::mergeColumns(const table_index_t column, std::string mergeStr) {
 
 
 /**
- *	Returns true, when the given column contains only numeric values.
+ *	Returns true, when the given column contains only numeric values (or empty cells).
  *	Tests up to maxNum cells or all, if maxNum == 0
+ *	Uses the parsed numbers of the storage if the column has already been parsed, probes the cells otherwise.
  */
 bool CsvTable::isNumericColumn(table_index_t col, table_index_t maxNum) {
 	if( col < 0 || col >= getNumberCols() ) {
@@ -882,14 +1013,15 @@ bool CsvTable::isNumericColumn(table_index_t col, table_index_t maxNum) {
 	if( maxNum == 0 || maxNum > getNumberRows() ) {
 		maxNum = getNumberRows();
 	}
-	bool ret = true;
+	const NumericColumn *numbers = storage.cachedNumbers(col);
 	for( table_index_t r = 0; r < maxNum; ++r ) {
-		if( !Helper::isNumber( getCell(r,col) ) ) {
-			ret = false;
-			break;
+		std::string_view cell = storage.getView(storageRow(r),col);
+		bool isNumber = numbers ? numbers->isNumber(storageRow(r)) : Helper::parseNumber(cell).myType != Helper::parseNumberType::NONE;
+		if( !isNumber && !cell.empty() ) {
+			return false;
 		}
 	}
-	return ret;
+	return true;
 }
 
 
@@ -898,18 +1030,14 @@ bool CsvTable::isNumericColumn(table_index_t col, table_index_t maxNum) {
  *	Flags a row: special selection for further actions
  */
 void CsvTable::flagRow(table_index_t rowNr, bool set) {
-	if( set ) {
-		flags.insert(rowNr);
-	} else {
-		flags.erase(rowNr);
+	// the bitmap grows up to the flagged row, so rows beyond the table must not get there
+	if( rowNr >= 0 && rowNr < getNumberRows() ) {
+		flags.set(rowNr, set);
 	}
 }
 
 bool CsvTable::isFlagged(table_index_t rowNr) {
-	if( flags.find(rowNr) != flags.end() ) {
-		return true;
-	}
-	return false;
+	return rowNr >= 0 && flags.test(rowNr);
 }
 
 
@@ -917,76 +1045,61 @@ bool CsvTable::isFlagged(table_index_t rowNr) {
  *	Returns the index of the next flagged row
  */
 table_index_t CsvTable::getNextFlaggedRow(table_index_t rowNr) {
-	std::set<table_index_t, std::greater<table_index_t> >::const_iterator iterReturn;
 	if( flags.empty() ) {
 		return -1;
 	}
-	auto it = flags.lower_bound(rowNr);
-	auto lastIt = flags.end();
-	--lastIt;						// lastIt now points to the last elemen (first flagged row)
-	if( it == flags.end() ) {
-		// 'it' above the first flagged row - starting at the last element (top-most in display)
-		it = lastIt;
-	} else {
-		if( it == flags.begin() ) {
-			it = lastIt;
-		} else {
-			--it;
-		}
+	size_t k = flags.rank( std::max(rowNr + 1, (table_index_t) 0) );		// number of flagged rows up to rowNr
+	if( k == flags.count() ) {
+		// below the last flagged row (in display) - starting at the first flagged row
+		k = 0;
 	}
-
-	return *it;
+	return (table_index_t) flags.select(k);
 }
 
 /*
  *	Returns the index of the previous flagged row
  */
 table_index_t CsvTable::getPrevFlaggedRow(table_index_t rowNr) {
-	std::set<table_index_t, std::greater<table_index_t> >::const_iterator iterReturn;
 	if( flags.empty() ) {
 		return -1;
 	}
-	auto it = flags.upper_bound(rowNr);
-	if( it == flags.end() ) {
-		// it reached end - starting at the beginning
-		it = flags.begin();
+	size_t k = flags.rank( std::max(rowNr, (table_index_t) 0) );			// number of flagged rows above rowNr
+	if( k == 0 ) {
+		// above the first flagged row (in display) - starting at the last flagged row
+		k = flags.count();
 	}
-
-	return *it;
+	return (table_index_t) flags.select(k - 1);
 }
 
 /**
- *	Move all flagged rows
+ *	Move all flagged rows from rowNr on by moveRows. If moveRows is negative, the flags of the rows
+ *	rowNr ... rowNr - moveRows - 1 are dropped, as these rows have been deleted.
  */
 void CsvTable::moveFlags(table_index_t rowNr, table_index_t moveRows) {
-	std::set<table_index_t, std::greater<table_index_t> > newFlags;
-	for (auto it = flags.begin(); it != flags.end(); ++it) {
-		if( *it >= rowNr ) {
-			// move flagged rows from rowNr and up (visually down)
-			newFlags.insert(*it + moveRows);
-		} else {
-			// keep flagged rows that are lower than rowNr
-			newFlags.insert(*it);
-		}
+	if( rowNr < 0 ) {
+		return;
+	}
+	if( moveRows > 0 ) {
+		flags.insert(rowNr, moveRows);
+	} else if( moveRows < 0 ) {
+		flags.erase(rowNr, rowNr - moveRows);
 	}
-	flags = newFlags;
 }
 
 
 /**
- *	Delete all rows that have been flagged
+ *	Delete all rows that have been flagged – or all rows that have not been flagged, if deleteFlagged is false.
+ *	Like delRows(), nothing is deleted if no row would be left.
  */
 void CsvTable::deleteFlaggedRows(bool deleteFlagged) {
-	std::set<table_index_t, std::greater<table_index_t> > newFlags = flags;
-	if( deleteFlagged ) {
-		// delete flagged rows
-		for (auto it = newFlags.begin(); it != newFlags.end(); ++it) {
-			delRows(*it,*it,false,false);		// TODO Call storage.deleteRows() instead?
-		}
-	// } else {
-	// 	// TODO delete non-flagged rows
-	// 	1;
+	table_index_t numToDel = deleteFlagged ? countFlaggedRows() : storage.rows() - countFlaggedRows();
+	if( numToDel >= storage.rows() ) {
+		return;
 	}
+	materializeRowOrder();
+	storage.deleteRowsIf( [this, deleteFlagged](table_index_t r) {
+		return flags.test(r) == deleteFlagged;
+	});
 	updateInternals();
 	flags.clear();
 }
@@ -996,13 +1109,7 @@ void CsvTable::deleteFlaggedRows(bool deleteFlagged) {
  *	Inverse all flagged rows
  */
 void CsvTable::invertFlags() {
-	std::set<table_index_t, std::greater<table_index_t> > inverseFlags;
-	for(table_index_t r = 0; r < getNumberRows(); ++r) {
-		if( !isFlagged(r) ) {
-			inverseFlags.insert(r);
-		}
-	}
-	flags = inverseFlags;
+	flags.invert(getNumberRows());
 	updateInternals();
 }
 
@@ -1011,7 +1118,7 @@ void CsvTable::invertFlags() {
  *	Returns the number of flagged rows
  */
 table_index_t CsvTable::countFlaggedRows() {
-	return (table_index_t) flags.size();
+	return (table_index_t) flags.count();
 }
 
 
@@ -1028,9 +1135,15 @@ table_index_t CsvTable::flagInconsistentData(table_index_t column) {
 	std::map<enum CellContentType, table_index_t> type_distribution;
 	table_index_t ROWS = getNumberRows();
 
-	// Guess type of each cell
+	// Guess type of each cell – for an encoded column only once per distinct value
+	const std::vector<std::string> &values = storage.dictionary(column);
+	std::vector<enum CellContentType> valueTypes(values.size());
+	for( size_t code = 0; code < values.size(); ++code ) {
+		valueTypes[code] = guessContentType(values[code]);
+	}
 	for( table_index_t r = 0; r < ROWS; ++r ) {
-		enum CellContentType my_type = guessContentType(getCell(r, column));
+		int32_t code = storage.getCode(storageRow(r), column);
+		enum CellContentType my_type = code >= 0 ? valueTypes[code] : guessContentType(getCell(r, column));
 		types.push_back(my_type);
 		auto it = type_distribution.find(my_type);
 		if(  it != type_distribution.end() ) {
@@ -1092,11 +1205,12 @@ CsvDataStorage &CsvTable::getStorage() {
 
 void CsvTable::setStorage(CsvDataStorage &storage) {
 	this->storage = storage;
+	rowOrder.clear();
 }
 
 
 bool CsvTable::cellContainsLineBreak(table_index_t R, table_index_t C) {
-	return storage.cellContainsLineBreak(R,C);
+	return storage.cellContainsLineBreak(storageRow(R),C);
 }
 
 
@@ -1133,6 +1247,11 @@ std::pair<int, int> CsvTable::maximumContentLength(table_index_t col, table_inde
 
 
 std::string CsvTable::vec2string(const std::vector<std::string> &line, CsvDefinition definition) {
+	std::vector<std::string_view> views(line.begin(), line.end());
+	return vec2string(views, definition);
+}
+
+std::string CsvTable::vec2string(const std::vector<std::string_view> &line, CsvDefinition definition) {
 	std::stringstream ret;
 	size_t cellLength;
 	for( size_t i = 0; i != line.size(); ++i) {
@@ -1158,14 +1277,14 @@ std::string CsvTable::vec2string(const std::vector<std::string> &line, CsvDefini
 
 
 // returns true if field has to be quoted
-bool CsvTable::toBeQuoted(std::string field, CsvDefinition definition) {
+bool CsvTable::toBeQuoted(std::string_view field, const CsvDefinition &definition) {
 	if( definition.quoteStyle == CsvDefinition::QUOTE_STYLE_ALL ) {
 		return true;
 	}
 	if( definition.quoteStyle == CsvDefinition::QUOTE_STYLE_STRING && !Helper::isNumber(field) && field != "" ) {
 		return true;
 	}
-	for( char& c : field ) {
+	for( const char& c : field ) {
 		// Line breaks, Field enclosures (double quotes) and Field separators (comma, semicolon, tab, bar) lead to quotation
 		if( c == '\n' || c == definition.quote || c == definition.delimiter ) {
 			return true;
@@ -31,7 +31,6 @@
 #include <tuple>
 #include <algorithm>
 #include <iterator>
-#include <set>
 
 
 // #include <FL/Fl.H>
@@ -42,6 +41,7 @@
 #include "helper.hh"
 #include "globals.hh"
 #include "csvdatastorage.hh"
+#include "rowbitmap.hh"
 
 // Used for stringstream and std::quoted in replaceUtf8String
 #include <iomanip>
@@ -63,7 +63,7 @@ class CsvTable {
 
 public:
 	std::vector<std::string> *headerRow;							// 1-dim array containing the row header names when custom header names are switched on / TODO: vec-of-vec for multiple header rows
-	std::set<table_index_t, std::greater<table_index_t> > flags;	// stores flagged rows, greater values are accessed first – sorted order is used for more effective deletion
+	RowBitmap flags;												// stores flagged rows, one bit per row
 	table_index_t s_left, s_top, s_right, s_bottom;					// current selection – only set by undo handling
 
 	enum saveReturnCode {
@@ -97,13 +97,17 @@ public:
 	table_index_t getNumberRows();
 	std::string getHeaderCell(table_index_t c, bool returnEmpty=true);
 	std::string getCell(table_index_t row, table_index_t col);
+	std::string_view getCellView(table_index_t row, table_index_t col);		// view into the storage, valid until the table gets modified
 	void setCell(std::string content, table_index_t row, table_index_t col);
 	std::vector< std::vector<std::string> > copyBlock(table_index_t row_top, table_index_t col_top, table_index_t row_bot, table_index_t col_bot);
 	std::vector<std::string> row(table_index_t R);
 	void addCol(table_index_t colNr, bool before=false);
 	void addRow(table_index_t rowNr, bool before=false);
+	void insertRows(table_index_t rowNr, const std::vector< std::vector<std::string> > &rows);
 	void delRows(table_index_t rowFrom, table_index_t rowTo, bool clearFlags=true, bool doUpdateInternals=true);
 	void delCols(table_index_t colFrom, table_index_t colTo);
+	std::vector<std::string> columnCells(table_index_t col);
+	void setColumnCells(table_index_t col, const std::vector<std::string> &cells);
 	void moveCols(table_index_t colFromStart, table_index_t colFromEnd, bool right);
 	std::tuple<table_index_t, table_index_t> findSubstring(std::string search, table_index_t startRow, table_index_t startCol, std::vector<table_index_t> sel, bool caseSensitive = false, bool useRegex = false);
 	bool findInCell(std::string search, table_index_t r, table_index_t c, bool caseSensitive = false, bool useRegex = false);
@@ -124,7 +128,12 @@ public:
 	table_index_t findHeaderRow(std::string query, table_index_t startCol = 0);
 	int saveCsv(std::string path, void (*cb)(const char*, void *), void *win, bool flaggedOnly = false, table_index_t fromRow=-1, table_index_t toRow=-1);
 	int exportJSON(std::string path, void (*cb)(const char*, void *), void *win, bool convertNumbers = true);
-	void sortTable(table_index_t column, bool ascending, int sortType=1);
+	void sortTable(table_index_t column, bool ascending, int sortType=1, CsvDataStorage::SortBackend backend=CsvDataStorage::SortBackend::AUTO);
+	void sortTable(const std::vector<CsvDataStorage::SortColumn> &sortColumns, CsvDataStorage::SortBackend backend=CsvDataStorage::SortBackend::AUTO);
+	bool isSortedView();																				// true if the rows are shown in a sorted order, see sortTable()
+	const std::vector<table_index_t> &getRowOrder();													// storage row of every table row, empty if shown in storage order
+	void setRowOrder(const std::vector<table_index_t> &order);
+	void materializeRowOrder();																			// applies the sorted order to the storage
 	void splitColumn(table_index_t column, std::string splitStr);
 	void mergeColumns(const table_index_t column, std::string mergeStr);
 	bool isNumericColumn(table_index_t col, table_index_t maxNum=0);
@@ -154,9 +163,13 @@ private:
 	CsvDefinition fileDefinition;					// the definition of the file as it has been opened
 	bool hasCustomHeaderRow = false;				// first row of CSV is considered a header row?
 	std::vector<table_index_t> searchArea;			// where findSubstring should search resp. where nextFields() iterates
+	std::vector<table_index_t> rowOrder;			// sorted view: the storage row of every table row – empty if the storage order is shown
+
+	table_index_t storageRow(table_index_t R);		// the storage row shown as table row R
 
 	std::string vec2string(const std::vector<std::string> &line, CsvDefinition definition);
-	bool toBeQuoted(std::string field, CsvDefinition definition);
+	std::string vec2string(const std::vector<std::string_view> &line, CsvDefinition definition);
+	bool toBeQuoted(std::string_view field, const CsvDefinition &definition);
 	void quoteString(std::string &data, std::ostream &output, CsvDefinition definition);
 	bool isEmptyLineVector(std::vector<std::string> *line);
 	std::string encode(std::string text, CsvDefinition::Encodings encoding);
@@ -44,7 +44,7 @@ void CsvUndo::createUndoStateTable(CsvTable &table, std::string descr) {
 	size_t size;
 	this->id = uniqNumber;
 	this->type = TCRUNCHER_UNDO_TYPE_TABLE;
-	this->undoStorage = table.getStorage();
+	this->undoStorage = table.getStorage();			// cheap: the copy shares its rows with the table until they change
 	size = table.headerRow->size();
 	this->headerRow.resize(size);
 	for( size_t r = 0; r < size; ++r) {
@@ -53,6 +53,7 @@ void CsvUndo::createUndoStateTable(CsvTable &table, std::string descr) {
 	this->descr = descr;
 	this->hasCustomHeaderRow = table.customHeaderRowShown();
 	this->flags = table.flags;
+	this->rowOrder = table.getRowOrder();
 	this->selection = { table.s_top, table.s_left, table.s_bottom, table.s_right };
 	// printf("createUndoStateTable: %s (%p) ID:%d\n", descr.c_str(), (void *)this->table, uniqNumber);
 }
@@ -68,15 +69,115 @@ void CsvUndo::createUndoStateCell(std::string cellContent, table_index_t R, tabl
 }
 
 
+/*
+ *	Stores just the row order of the table, enough to undo sorting it (see CsvTable::sortTable())
+ */
+void CsvUndo::createUndoStateOrder(CsvTable &table, std::string descr) {
+	this->id = uniqNumber;
+	this->type = TCRUNCHER_UNDO_TYPE_ORDER;
+	this->rowOrder = table.getRowOrder();
+	this->descr = descr;
+	this->hasCustomHeaderRow = table.customHeaderRowShown();
+	this->selection = { table.s_top, table.s_left, table.s_bottom, table.s_right };
+}
+
+
+/*
+ *	Stores `removedRows` rows from R on, which are going to be deleted, including their flags. `insertedRows` rows
+ *	are going to be inserted at R, they are just counted.
+ */
+void CsvUndo::createUndoStateRows(CsvTable &table, table_index_t R, table_index_t insertedRows, table_index_t removedRows, std::string descr) {
+	this->id = uniqNumber;
+	this->type = TCRUNCHER_UNDO_TYPE_ROWS;
+	this->R = R;
+	this->insertedCount = insertedRows;
+	for( table_index_t r = R; r < R + removedRows; ++r ) {
+		this->removedData.push_back( table.row(r) );
+		this->removedFlags.push_back( table.isFlagged(r) );
+	}
+	this->descr = descr;
+	this->hasCustomHeaderRow = table.customHeaderRowShown();
+	this->selection = { table.s_top, table.s_left, table.s_bottom, table.s_right };
+}
+
+
+/*
+ *	Stores `removedColumns` columns from C on, which are going to be deleted, and the cells of `changedColumn`
+ *	(if not -1), which are going to be changed. `insertedColumns` columns are going to be inserted at C, they
+ *	are just counted.
+ */
+void CsvUndo::createUndoStateColumns(CsvTable &table, table_index_t C, table_index_t insertedColumns, table_index_t removedColumns, table_index_t changedColumn, std::string descr) {
+	this->id = uniqNumber;
+	this->type = TCRUNCHER_UNDO_TYPE_COLUMNS;
+	this->C = C;
+	this->insertedCount = insertedColumns;
+	for( table_index_t c = C; c < C + removedColumns; ++c ) {
+		this->removedData.push_back( table.columnCells(c) );
+		this->removedHeaders.push_back( table.getHeaderCell(c) );
+	}
+	this->changedColumn = changedColumn;
+	if( changedColumn >= 0 ) {
+		this->changedCells = table.columnCells(changedColumn);
+	}
+	this->descr = descr;
+	this->hasCustomHeaderRow = table.customHeaderRowShown();
+	this->selection = { table.s_top, table.s_left, table.s_bottom, table.s_right };
+}
+
+
+/*
+ *	Stores where the columns colFromStart ... colFromEnd are going to be moved to (see CsvTable::moveCols())
+ */
+void CsvUndo::createUndoStateMoveColumns(CsvTable &table, table_index_t colFromStart, table_index_t colFromEnd, bool right, std::string descr) {
+	this->id = uniqNumber;
+	this->type = TCRUNCHER_UNDO_TYPE_MOVE_COLUMNS;
+	this->C = right ? colFromStart + 1 : colFromStart - 1;
+	this->lastColumn = right ? colFromEnd + 1 : colFromEnd - 1;
+	this->movedRight = right;
+	this->descr = descr;
+	this->hasCustomHeaderRow = table.customHeaderRowShown();
+	this->selection = { table.s_top, table.s_left, table.s_bottom, table.s_right };
+}
+
+
+/*
+ *	Stores the header row state before it's switched (see CsvTable::switchHeader())
+ */
+void CsvUndo::createUndoStateHeaderRow(CsvTable &table, std::string descr) {
+	this->id = uniqNumber;
+	this->type = TCRUNCHER_UNDO_TYPE_HEADERROW;
+	this->hasCustomHeaderRow = table.customHeaderRowShown();
+	this->firstRowFlagged = table.isFlagged(0);
+	this->descr = descr;
+}
+
+
+/*
+ *	Stores the flags of the table
+ */
+void CsvUndo::createUndoStateFlags(CsvTable &table, std::string descr) {
+	this->id = uniqNumber;
+	this->type = TCRUNCHER_UNDO_TYPE_FLAGS;
+	this->flags = table.flags;
+	this->descr = descr;
+	this->hasCustomHeaderRow = table.customHeaderRowShown();
+}
+
+
 CsvDataStorage &CsvUndo::getUndoStorage() {
 	return undoStorage;
 }
 
-std::set<table_index_t, std::greater<table_index_t> > &CsvUndo::getFlags() {
+RowBitmap &CsvUndo::getFlags() {
 	return flags;
 }
 
 
+std::vector<table_index_t> &CsvUndo::getRowOrder() {
+	return rowOrder;
+}
+
+
 std::vector<std::string> &CsvUndo::getHeaderRow() {
 	return headerRow;
 }
@@ -105,6 +206,38 @@ std::string CsvUndo::getCellContent() {
 	return prevCellContent;
 }
 
+table_index_t CsvUndo::getInsertedCount() {
+	return insertedCount;
+}
+
+std::vector< std::vector<std::string> > &CsvUndo::getRemovedData() {
+	return removedData;
+}
+
+std::vector<std::string> &CsvUndo::getRemovedHeaders() {
+	return removedHeaders;
+}
+
+std::vector<bool> &CsvUndo::getRemovedFlags() {
+	return removedFlags;
+}
+
+table_index_t CsvUndo::getChangedColumn() {
+	return changedColumn;
+}
+
+std::vector<std::string> &CsvUndo::getChangedCells() {
+	return changedCells;
+}
+
+std::tuple<table_index_t,table_index_t,bool> CsvUndo::getMovedColumns() {
+	return std::make_tuple(C, lastColumn, movedRight);
+}
+
+bool CsvUndo::getFirstRowFlagged() {
+	return firstRowFlagged;
+}
+
 int CsvUndo::getId() {
 	return id;
 }
@@ -29,7 +29,6 @@
 
 #include <tuple>
 #include <vector>
-#include <set>
 
 /*
  *	A single Undo state.
@@ -44,14 +43,29 @@ public:
 	~CsvUndo();
 	void createUndoStateTable(CsvTable &table, std::string descr);
 	void createUndoStateCell(std::string cellContent, table_index_t R, table_index_t C, bool hasCustomHeaderRow, std::string descr);
+	void createUndoStateOrder(CsvTable &table, std::string descr);
+	void createUndoStateRows(CsvTable &table, table_index_t R, table_index_t insertedRows, table_index_t removedRows, std::string descr);
+	void createUndoStateColumns(CsvTable &table, table_index_t C, table_index_t insertedColumns, table_index_t removedColumns, table_index_t changedColumn, std::string descr);
+	void createUndoStateMoveColumns(CsvTable &table, table_index_t colFromStart, table_index_t colFromEnd, bool right, std::string descr);
+	void createUndoStateHeaderRow(CsvTable &table, std::string descr);
+	void createUndoStateFlags(CsvTable &table, std::string descr);
 	CsvDataStorage &getUndoStorage();
-	std::set<table_index_t, std::greater<table_index_t> > &getFlags();
+	RowBitmap &getFlags();
+	std::vector<table_index_t> &getRowOrder();
 	std::vector<std::string> &getHeaderRow();
 	bool getSwitchHeaderRow();
 	std::string getDescr();
 	int getType();
 	std::tuple<table_index_t,table_index_t> getCellPosition();
 	std::string getCellContent();
+	table_index_t getInsertedCount();
+	std::vector< std::vector<std::string> > &getRemovedData();
+	std::vector<std::string> &getRemovedHeaders();
+	std::vector<bool> &getRemovedFlags();
+	table_index_t getChangedColumn();
+	std::vector<std::string> &getChangedCells();
+	std::tuple<table_index_t,table_index_t,bool> getMovedColumns();
+	bool getFirstRowFlagged();
 	int getId();
 	void deleteTable();
 	std::vector<table_index_t> getSelection();
@@ -66,13 +80,24 @@ private:
 	std::string descr;
 	CsvDataStorage undoStorage;
 	std::vector<std::string> headerRow;
-	std::set<table_index_t, std::greater<table_index_t> > flags;
+	RowBitmap flags;
+	std::vector<table_index_t> rowOrder;			// the row order of the table (see CsvTable::getRowOrder())
 	bool hasCustomHeaderRow;
 	std::vector<table_index_t> selection;
 	// stores a single cell: when just a cell has been affected
 	std::string prevCellContent;
 	table_index_t R;
 	table_index_t C;
+	// structural changes at R resp. C: only the removed and changed data is stored
+	table_index_t insertedCount = 0;				// number of rows or columns inserted at R resp. C
+	std::vector< std::vector<std::string> > removedData;	// the removed rows – or the cells of every removed column
+	std::vector<std::string> removedHeaders;		// the header cells of the removed columns
+	std::vector<bool> removedFlags;					// the flags of the removed rows
+	table_index_t changedColumn = -1;				// column whose cells have been changed, -1 if none
+	std::vector<std::string> changedCells;			// the previous cells of changedColumn
+	table_index_t lastColumn;						// moved columns: C ... lastColumn is their new position
+	bool movedRight;
+	bool firstRowFlagged = false;					// header row switched on: the flag of the row that became the header
 };
 
 
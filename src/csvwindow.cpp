@@ -61,6 +61,11 @@ int My_Fl_Double_Window::handle(int event) {
 	switch( event ) {
 		case FL_SHORTCUT:
 			app.getWindowByPointer(this);
+			if( key == FL_Escape && windows[windowIndex].isLoading() ) {
+				// ESC stops loading the file
+				windows[windowIndex].stopLoading();
+				return(1);
+			}
 			if( Fl::event_command() && key == 'q' && !Fl::event_shift() && !Fl::event_ctrl() && !Fl::event_alt() ) {
 				#ifdef __APPLE__
 				// CMD q
@@ -295,6 +300,8 @@ void CsvWindow::create(int createdWindowCount) {
 
 
 void CsvWindow::destroy() {
+	delete(loader);
+	loader = nullptr;
 	delete(win);
 	delete(table);
 }
@@ -328,16 +335,19 @@ void CsvWindow::setWindowSlotUsed(bool state) {
 /**
  *	Loads file from 'filename'. Any checks if window objects is in use and so on has to be done before.
  *	Returns true, when the file could be loaded.
+ *
+ *	The file gets parsed on a thread of its own (see `CsvLoader`). We wait for the first rows only, the remaining
+ *	ones get appended in the background by continueLoading() while the grid can already be scrolled.
  */
 bool CsvWindow::loadFile(std::string filename, bool askUser, bool reopen) {
 	std::ifstream input;
 	long fileLength;
-	std::stringstream sstr;
-	CsvParser *parser = new CsvParser();
 	std::pair<CsvDefinition::Encodings, int> guessedEncoding;
 	std::pair<CsvDefinition, float> guessedDefinition;
 	CsvDefinition definition;
-	std::map<long,long> histogram;
+	std::map<table_index_t,table_index_t> histogram;
+	bool loaded;
+	bool stopped = false;
 
 	if( app.isAlreadyOpened(filename) && !reopen ) {
 		CsvApplication::myFlChoice("", "File is already open!", {"Okay"});
@@ -367,6 +377,9 @@ bool CsvWindow::loadFile(std::string filename, bool askUser, bool reopen) {
 		}
 	}
 	
+	// a file still being loaded into this window gets replaced
+	stopLoading();
+
 	// Switch off custom header row
 	if( table->customHeaderRowShown() ) {
 		showHeaderCheckbox->clear();
@@ -375,15 +388,32 @@ bool CsvWindow::loadFile(std::string filename, bool askUser, bool reopen) {
 	}
 	
 	// Start timing
-	time_t startTime = std::time(0);
+	loadingStartTime = std::time(0);
 	
 	// Tabelle leeren und geparste Daten laden
 	table->clearTable();
 	app.showImWorkingWindow("Opening file ...", true);
-	histogram = parser->parseCsvStream(&input, table->getStorage(), &definition);
+	loader = new CsvLoader(std::move(input), definition, fileLength, &loadingCB, this);
+	// wait for the first rows – smaller files have been loaded completely by then
+	while( !(loaded = loader->collect(table->getStorage())) && table->getNumberRows() == 0 ) {
+		Fl::wait(0.1);
+	}
 	app.hideImWorkingWindow();
+	if( loaded ) {
+		// stopLoading() may have cancelled the loader meanwhile (ESC, closing the window)
+		stopped = !loader->isComplete();
+		if( stopped ) {
+			delete loader;
+			loader = nullptr;
+		} else {
+			histogram = finishLoading();
+		}
+	}
 	table->updateInternals();
 	if( table->getNumberRows() == 0 || table->getNumberCols() == 0 ) {
+		if( stopped ) {
+			return false;
+		}
 		if( askUser ) {
 			CsvApplication::myFlChoice("", "Could not open file with the choosen CSV definition!", {"Okay"});			
 		} else {
@@ -395,10 +425,8 @@ bool CsvWindow::loadFile(std::string filename, bool askUser, bool reopen) {
 
 
 	// Grid-Größe anpassen
-	grid->rows( table->getNumberRows() );
+	grid->setTableRows( table->getNumberRows() );
 	grid->cols( table->getNumberCols() );
-	
-	int durationSecs = std::difftime(std::time(0), startTime);
 
 	// Sets the filename as the window name
 	setPath(filename);
@@ -406,10 +434,11 @@ bool CsvWindow::loadFile(std::string filename, bool askUser, bool reopen) {
 	setUsed(true);
 
 	// Set statusbar information
-	sstr.str("");
-	sstr.clear();
-	sstr << "File " << getName() << " opened in " << durationSecs << " seconds.";
-	updateStatusbar(sstr.str());
+	if( !loaded ) {
+		showLoadingStatus();
+	} else if( !stopped ) {
+		showLoadedStatus();
+	}
 	
 	// update TypeButton
 	setTypeButton(definition);
@@ -427,12 +456,20 @@ bool CsvWindow::loadFile(std::string filename, bool askUser, bool reopen) {
 	// switch UNDO on
 	enableUndo();
 
+	if( stopped ) {
+		markIncomplete();
+	}
+	if( !loaded ) {
+		// the remaining rows follow in the background
+		setLoadingControls(true);
+		loadingInBackground = true;
+	}
+
 	// Tabelle darstellen
 	grid->redraw();
 	win->redraw();
 	win->flush();
 	Fl::check();
-	delete(parser);
 	
 	//
 	//	Show warning on large table
@@ -455,15 +492,135 @@ bool CsvWindow::loadFile(std::string filename, bool askUser, bool reopen) {
 	// #endif
 	
 	
-	if( histogram.size() != 1 ) {
-		CsvApplication::myFlChoice("Warning", "Tablecruncher found "+std::to_string(histogram.size())+" different row lengths in your CSV file. Please check your data to be sure you used the correct definition.", {"OK"});
+	if( loaded && !stopped ) {
+		showLoadWarnings(histogram);
 	}
 	
-	
 	return true;
 }
 
 
+bool CsvWindow::isLoading() {
+	return loader != nullptr;
+}
+
+
+/**
+ *	Stops loading a file in the background. The rows loaded so far stay in the table, but the window forgets the
+ *	path of the file, so saving them can't overwrite the complete file.
+ */
+void CsvWindow::stopLoading() {
+	if( !isLoading() ) {
+		return;
+	}
+	loader->cancel();
+	if( !loadingInBackground || loader->isComplete() ) {
+		// loadFile() still waits for the first rows and notices the cancel, or all rows have been loaded anyway
+		continueLoading();
+		return;
+	}
+	loader->collect(table->getStorage());
+	delete loader;
+	loader = nullptr;
+	loadingInBackground = false;
+	setLoadingControls(false);
+	updateTable();
+	markIncomplete();
+}
+
+
+/*
+ *	Keeps the rows of a stopped loading, but not the path of the file – saving them mustn't overwrite the complete file
+ */
+void CsvWindow::markIncomplete() {
+	setPath("");
+	setName(getName() + " (incomplete)");
+	updateStatusbar("Stopped loading after " + std::to_string(table->getNumberRows()) + " rows.");
+}
+
+
+/*
+ *	Called on the main thread by Fl::awake() when the loader has new rows
+ */
+void CsvWindow::loadingCB(void *win) {
+	((CsvWindow *) win)->continueLoading();
+}
+
+
+/*
+ *	Appends the rows the loader has published meanwhile and shows them. Finishes the table after the last ones.
+ */
+void CsvWindow::continueLoading() {
+	if( !loadingInBackground ) {
+		// loadFile() collects the first rows itself
+		return;
+	}
+	if( loader->collect(table->getStorage()) ) {
+		std::map<table_index_t,table_index_t> histogram = finishLoading();
+		loadingInBackground = false;
+		setLoadingControls(false);
+		updateTable();
+		showLoadedStatus();
+		showLoadWarnings(histogram);
+	} else {
+		updateTable();
+		showLoadingStatus();
+	}
+}
+
+
+/*
+ *	Deletes the loader, which has delivered all rows, and finishes the table like CsvParser::parseCsvStream() does
+ */
+std::map<table_index_t,table_index_t> CsvWindow::finishLoading() {
+	std::map<table_index_t,table_index_t> histogram = loader->rowLengths();
+	delete loader;
+	loader = nullptr;
+	CsvParser::finishStorage(table->getStorage());
+	return histogram;
+}
+
+
+void CsvWindow::setLoadingControls(bool loading) {
+	grid->setReadOnly(loading);
+	if( loading ) {
+		toolbar->deactivate();
+	} else {
+		toolbar->activate();
+	}
+}
+
+
+void CsvWindow::showLoadingStatus() {
+	std::stringstream sstr;
+	sstr << "Loading " << getName() << " ... " << table->getNumberRows() << " rows (" << loader->percent() << "%) – press Esc to stop.";
+	// not by updateStatusbar(): its Fl::check() could run continueLoading() again while we're still in there
+	statusbarText = sstr.str();
+	statusbar->copy_label(statusbarText.c_str());
+	statusbar->redraw();
+}
+
+
+void CsvWindow::showLoadedStatus() {
+	std::stringstream sstr;
+	int durationSecs = std::difftime(std::time(0), loadingStartTime);
+	sstr << "File " << getName() << " opened in " << durationSecs << " seconds.";
+	updateStatusbar(sstr.str());
+}
+
+
+void CsvWindow::showLoadWarnings(const std::map<table_index_t,table_index_t> &histogram) {
+	if( histogram.size() != 1 ) {
+		CsvApplication::myFlChoice("Warning", "Tablecruncher found "+std::to_string(histogram.size())+" different row lengths in your CSV file. Please check your data to be sure you used the correct definition.", {"OK"});
+	}
+	if( grid->isTruncated() ) {
+		CsvApplication::myFlChoice("Info", "The grid can only display the first "+std::to_string(TCRUNCHER_MAX_GRID_ROWS)+" rows. All "+std::to_string(table->getNumberRows())+" rows are kept and will be searched, sorted and saved.", {"OK"});
+	}
+}
+
+
+
+
 void CsvWindow::setUsed(bool used) {
 	this->used = used;
 }
@@ -571,6 +728,7 @@ void CsvWindow::showInfoWindow() {
 					"<br>" <<
 					"Rows: " <<
 					table->getNumberRows() <<
+					(grid->isTruncated() ? " (only the first " + std::to_string(TCRUNCHER_MAX_GRID_ROWS) + " are displayed)" : "") <<
 					"<br>" <<
 					"Columns: " <<
 					table->getNumberCols() <<
@@ -674,7 +832,7 @@ void CsvWindow::readWindowPreferences() {
 			}
 			// show or hide headers if needed
 			if( winJson["header-set"].get<bool>() != table->customHeaderRowShown() ) {
-				app.switchHeaderRowCB(NULL,NULL);
+				app.switchHeaderRow();
 			}
 		} catch(const std::exception& e) {
 			std::cerr << "Error reading file preferences." << std::endl;
@@ -693,9 +851,9 @@ void CsvWindow::setTypeButton(CsvDefinition definition) {
 
 
 std::string CsvWindow::humanReadableSelection() {
-	long rows = table->getNumberRows();
-	long cols = table->getNumberCols();
-	std::vector<int> sel = grid->getSelection();
+	table_index_t rows = table->getNumberRows();
+	table_index_t cols = table->getNumberCols();
+	std::vector<table_index_t> sel = grid->getSelection();
 	std::string human = "";
 	if(
 		(sel[0] == sel[2] && sel[1] == sel[3]) ||
@@ -730,7 +888,7 @@ void CsvWindow::windowGetsClosedCB(Fl_Widget *widget, void *) {
  */
 void CsvWindow::updateTable() {
 	table->updateInternals();
-	grid->rows( table->getNumberRows() );
+	grid->setTableRows( table->getNumberRows() );
 	grid->cols( table->getNumberCols() );
 	grid->redraw();
 }
@@ -743,17 +901,25 @@ void CsvWindow::addUndoStateTable(std::string descr) {
 	if( undoDisabled )
 		return;
 	CsvUndo ustate;
-	int row_top, row_bottom, col_top, col_bottom;
-	grid->get_selection(row_top, col_top, row_bottom, col_bottom);
-	table->s_top = row_top;
-	table->s_bottom = row_bottom;
-	table->s_left = col_top;
-	table->s_right = col_bottom;
+	rememberSelection();
 	ustate.createUndoStateTable(*table, descr);
 	undoList.push_back(ustate);
 	app.setUndoMenuItem(true);
 }
 
+/*
+ *	Stores just the row order of the table as Undo state – used before sorting, which doesn't change the storage
+ */
+void CsvWindow::addUndoStateOrder(std::string descr) {
+	if( undoDisabled )
+		return;
+	CsvUndo ustate;
+	rememberSelection();
+	ustate.createUndoStateOrder(*table, descr);
+	undoList.push_back(ustate);
+	app.setUndoMenuItem(true);
+}
+
 /*
  *	Stores just a single cell as an Undo state
  */
@@ -768,22 +934,116 @@ void CsvWindow::addUndoStateCell(std::string cellContent, int R, int C, std::str
 
 
 
+/*
+ *	Stores rows that are going to be inserted or deleted as Undo state – only the deleted rows are stored.
+ *	Inserting and deleting rows applies a sorted row order to the storage, so a sorted table gets stored
+ *	completely, keeping the storage rows of the former Undo states valid.
+ */
+void CsvWindow::addUndoStateRows(table_index_t R, table_index_t insertedRows, table_index_t removedRows, std::string descr) {
+	if( undoDisabled )
+		return;
+	if( table->isSortedView() ) {
+		addUndoStateTable(descr);
+		return;
+	}
+	rememberSelection();
+	undoList.emplace_back();						// created in place, the removed rows aren't copied
+	undoList.back().createUndoStateRows(*table, R, insertedRows, removedRows, descr);
+	app.setUndoMenuItem(true);
+}
+
+/*
+ *	Stores columns that are going to be inserted, deleted or changed as Undo state – only the deleted and
+ *	changed columns are stored
+ */
+void CsvWindow::addUndoStateColumns(table_index_t C, table_index_t insertedColumns, table_index_t removedColumns, table_index_t changedColumn, std::string descr) {
+	if( undoDisabled )
+		return;
+	rememberSelection();
+	undoList.emplace_back();						// created in place, the removed columns aren't copied
+	undoList.back().createUndoStateColumns(*table, C, insertedColumns, removedColumns, changedColumn, descr);
+	app.setUndoMenuItem(true);
+}
+
+/*
+ *	Stores columns that are going to be moved by one column as Undo state
+ */
+void CsvWindow::addUndoStateMoveColumns(table_index_t colFromStart, table_index_t colFromEnd, bool right, std::string descr) {
+	if( undoDisabled )
+		return;
+	CsvUndo ustate;
+	rememberSelection();
+	ustate.createUndoStateMoveColumns(*table, colFromStart, colFromEnd, right, descr);
+	undoList.push_back(ustate);
+	app.setUndoMenuItem(true);
+}
+
+/*
+ *	Stores the header row state before switching it as Undo state – like addUndoStateRows() a sorted table
+ *	gets stored completely
+ */
+void CsvWindow::addUndoStateHeaderRow(std::string descr) {
+	if( undoDisabled )
+		return;
+	if( table->isSortedView() ) {
+		addUndoStateTable(descr);
+		return;
+	}
+	CsvUndo ustate;
+	ustate.createUndoStateHeaderRow(*table, descr);
+	undoList.push_back(ustate);
+	app.setUndoMenuItem(true);
+}
+
+/*
+ *	Stores just the flags as Undo state
+ */
+void CsvWindow::addUndoStateFlags(std::string descr) {
+	if( undoDisabled )
+		return;
+	CsvUndo ustate;
+	ustate.createUndoStateFlags(*table, descr);
+	undoList.push_back(ustate);
+	app.setUndoMenuItem(true);
+}
+
+
+void CsvWindow::rememberSelection() {
+	int row_top, row_bottom, col_top, col_bottom;
+	grid->get_selection(row_top, col_top, row_bottom, col_bottom);
+	table->s_top = row_top;
+	table->s_bottom = row_bottom;
+	table->s_left = col_top;
+	table->s_right = col_bottom;
+}
+
+
+void CsvWindow::restoreSelection(CsvUndo &ustate) {
+	std::vector<table_index_t> selection = ustate.getSelection();
+	if( selection.size() == 4 ) {
+		grid->set_selection(selection[0],selection[1],selection[2],selection[3]);
+	}
+}
+
+
+
 void CsvWindow::undo() {
 	if( undoDisabled )
 		return;
 	bool undoSuccess = false;
 	std::string undoDescr;
 	size_t size;
-	std::vector<int> selection;
-	int undoType, R, C;
+	int undoType;
+	table_index_t R, C;
 	if( !undoList.empty() ) {
-		CsvUndo ustate = undoList.back();
+		CsvUndo &ustate = undoList.back();				// not copied: delta states may hold a lot of removed rows
 		undoDescr = ustate.getDescr();
 		undoType = ustate.getType();
 		// int myUniqNumber = ustate.getId();
 		switch( undoType ) {
 			case TCRUNCHER_UNDO_TYPE_TABLE:
 				table->setStorage( ustate.getUndoStorage() );
+				table->setRowOrder( ustate.getRowOrder() );
 				delete(table->headerRow);						// delete recent headerRow
 				size = ustate.getHeaderRow().size();
 				table->headerRow = new std::vector<std::string>();
@@ -792,13 +1052,10 @@ void CsvWindow::undo() {
 					table->headerRow->at(r) = ustate.getHeaderRow().at(r);
 				}
 				table->flags = ustate.getFlags();
-				selection = ustate.getSelection();
-				if( selection.size() == 4 ) {
-					grid->set_selection(selection[0],selection[1],selection[2],selection[3]);
-				}
+				restoreSelection(ustate);
 				table->updateInternals();
 				grid->cols( table->getNumberCols() );
-				grid->rows( table->getNumberRows() );
+				grid->setTableRows( table->getNumberRows() );
 				grid->redraw();
 				if( ustate.getSwitchHeaderRow() != table->customHeaderRowShown() ) {
 					table->setCustomHeaderRowShown( ustate.getSwitchHeaderRow() );
@@ -811,9 +1068,15 @@ void CsvWindow::undo() {
 				showHeaderCheckbox->redraw();
 				undoSuccess = true;
 			break;
+			case TCRUNCHER_UNDO_TYPE_ORDER:
+				table->setRowOrder( ustate.getRowOrder() );
+				restoreSelection(ustate);
+				grid->redraw();
+				undoSuccess = true;
+			break;
 			case TCRUNCHER_UNDO_TYPE_CELL:
 				if( ustate.getSwitchHeaderRow() != table->customHeaderRowShown() ) {
-					app.switchHeaderRowCB(NULL, NULL);
+					app.switchHeaderRow();
 					showHeaderCheckbox->redraw();
 				}
 				std::tie(R,C) = ustate.getCellPosition();
@@ -821,6 +1084,69 @@ void CsvWindow::undo() {
 				grid->redraw();
 				undoSuccess = true;
 			break;
+			case TCRUNCHER_UNDO_TYPE_ROWS:
+				std::tie(R,C) = ustate.getCellPosition();
+				if( ustate.getInsertedCount() > 0 ) {
+					table->delRows(R, R + ustate.getInsertedCount() - 1);
+				}
+				if( !ustate.getRemovedData().empty() ) {
+					table->insertRows(R, ustate.getRemovedData());
+					for( size_t r = 0; r < ustate.getRemovedFlags().size(); ++r ) {
+						if( ustate.getRemovedFlags()[r] ) {
+							table->flagRow(R + r, true);
+						}
+					}
+				}
+				restoreSelection(ustate);
+				updateTable();
+				undoSuccess = true;
+			break;
+			case TCRUNCHER_UNDO_TYPE_COLUMNS:
+				std::tie(R,C) = ustate.getCellPosition();
+				if( ustate.getInsertedCount() > 0 ) {
+					table->delCols(C, C + ustate.getInsertedCount() - 1);
+				}
+				for( size_t i = 0; i < ustate.getRemovedData().size(); ++i ) {
+					table_index_t column = C + i;
+					if( column < table->getNumberCols() ) {
+						table->addCol(column, true);
+					} else {
+						table->addCol(table->getNumberCols() - 1, false);
+					}
+					table->headerRow->at(column) = ustate.getRemovedHeaders().at(i);
+					table->setColumnCells(column, ustate.getRemovedData().at(i));
+				}
+				if( ustate.getChangedColumn() >= 0 ) {
+					table->setColumnCells(ustate.getChangedColumn(), ustate.getChangedCells());
+				}
+				restoreSelection(ustate);
+				updateTable();
+				undoSuccess = true;
+			break;
+			case TCRUNCHER_UNDO_TYPE_MOVE_COLUMNS: {
+				table_index_t lastColumn;
+				bool movedRight;
+				std::tie(C, lastColumn, movedRight) = ustate.getMovedColumns();
+				table->moveCols(C, lastColumn, !movedRight);
+				restoreSelection(ustate);
+				grid->redraw();
+				undoSuccess = true;
+			}
+			break;
+			case TCRUNCHER_UNDO_TYPE_HEADERROW:
+				if( ustate.getSwitchHeaderRow() != table->customHeaderRowShown() ) {
+					app.switchHeaderRow();
+					if( ustate.getFirstRowFlagged() ) {
+						table->flagRow(0, true);
+					}
+				}
+				undoSuccess = true;
+			break;
+			case TCRUNCHER_UNDO_TYPE_FLAGS:
+				table->flags = ustate.getFlags();
+				grid->redraw();
+				undoSuccess = true;
+			break;
 			default:
 			break;
 		}
@@ -830,8 +1156,7 @@ void CsvWindow::undo() {
 			if( undoSaveState == -1 && undoList.empty() ) {		// no UNDO state has been saved so far
 				setToChanged = false;
 			} else if( !undoList.empty() ) {
-				ustate = undoList.back();
-				if( undoSaveState == ustate.getId() ) {
+				if( undoSaveState == undoList.back().getId() ) {
 					setToChanged = false;
 				}
 			}
@@ -868,8 +1193,7 @@ void CsvWindow::removeLastUndoState() {
  */
 void CsvWindow::setUndoSaveState() {
 	if( !undoList.empty() ) {
-		CsvUndo ustate = undoList.back();
-		undoSaveState = ustate.getId();
+		undoSaveState = undoList.back().getId();
 	}
 }
 
@@ -893,12 +1217,7 @@ bool CsvWindow::isUndoDisabled() {
 
 
 void CsvWindow::clearUndoList() {
-	CsvUndo ustate;
-	while( !undoList.empty() ) {
-		ustate = undoList.back();
-		// ustate.deleteTable();
-		undoList.pop_back();
-	}
+	undoList.clear();
 }
 
 
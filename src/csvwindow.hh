@@ -57,6 +57,7 @@
 #include "csvtable.hh"
 #include "csvapplication.hh"
 #include "csvparser.hh"
+#include "csvloader.hh"
 
 
 namespace ui_icons {
@@ -110,6 +111,9 @@ public:
 	bool getWindowSlotUsed();										// Is this window active (visible)?
 	void setWindowSlotUsed(bool state);
 	bool loadFile(std::string filename, bool askUser=false, bool reopen=false);
+	bool isLoading();												// is a file being loaded in the background?
+	void stopLoading();												// stops loading, the rows loaded so far are kept
+	static void loadingCB(void *win);
 	void setUsed(bool used);										// has this been used since creation? Not to be confused with getWindowSlotUsed()
 	bool isUsed();
 	void setChanged(bool changed);
@@ -122,7 +126,13 @@ public:
 	static void windowGetsClosedCB(Fl_Widget *widget, void *);
 	void updateTable();												// updates the internals of CsvTable and the displayed grid
 	void addUndoStateTable(std::string descr);
+	void addUndoStateOrder(std::string descr);
 	void addUndoStateCell(std::string cellContent, int R, int C, std::string descr);
+	void addUndoStateRows(table_index_t R, table_index_t insertedRows, table_index_t removedRows, std::string descr);
+	void addUndoStateColumns(table_index_t C, table_index_t insertedColumns, table_index_t removedColumns, table_index_t changedColumn, std::string descr);
+	void addUndoStateMoveColumns(table_index_t colFromStart, table_index_t colFromEnd, bool right, std::string descr);
+	void addUndoStateHeaderRow(std::string descr);
+	void addUndoStateFlags(std::string descr);
 	void undo();
 	bool hasUndoStates();
 	void removeLastUndoState();
@@ -160,6 +170,19 @@ private:
 	std::deque< CsvUndo > undoList;
 	int undoSaveState = -1;									// undoList.uniqNumber for which the last save command was issued
 	bool undoDisabled = false;								// set true to disable undo (necessary for large files)
+	CsvLoader *loader = nullptr;							// loads the opened file, see loadFile()
+	bool loadingInBackground = false;						// true once loadFile() has returned while `loader` is still busy
+	time_t loadingStartTime = 0;
+
+	void rememberSelection();								// copies the grid selection to the table, to be stored in an undo state
+	void restoreSelection(CsvUndo &ustate);
+	void continueLoading();									// takes the rows loaded in the background meanwhile
+	std::map<table_index_t,table_index_t> finishLoading();	// completes the table once all rows have been collected, returns the row lengths histogram
+	void setLoadingControls(bool loading);					// makes the window read-only while loading in the background
+	void markIncomplete();									// forgets the path of a file whose loading has been stopped
+	void showLoadingStatus();
+	void showLoadedStatus();
+	void showLoadWarnings(const std::map<table_index_t,table_index_t> &histogram);
 
 };
 
@@ -27,13 +27,14 @@
 #include <iostream>
 #include <tuple>
 #include <cstdint>
+#include <climits>
 #include <string>
 #include <map>
 #include <vector>
 
 
 
-typedef int table_index_t;
+typedef int64_t table_index_t;			// row and column indices – 64 bit, but note that Fl_Table (CsvGrid) is limited to int
 
 
 #define TCRUNCHER_APP_NAME "Tablecruncher"
@@ -52,6 +53,7 @@ const int TCRUNCHER_PREF_UPDATE_CHECK_DAYS = 2;				// check two days
 #define TCRUNCHER_PREF_UPDATE_CHECK_ALLOWED "updateCheckAllowed"
 #define TCRUNCHER_PREF_SHOWED_ONBOARDING "showedOnboarding"
 #define TCRUNCHER_PREF_GRID_TEXT_FONT "gridTextFont"
+#define TCRUNCHER_PREF_SORT_MEMORY_PERCENT "sortMemoryPercent"	// memory budget for sorting in percent of the physical memory, above it temporary files are used
 #define TCRUNCHER_PREF_RECENT_FILES_STUB "recent_file_"
 #define TCRUNCHER_PREF_RECENT_FILES_NUM 9
 
@@ -92,6 +94,11 @@ const int TCRUNCHER_TOOLBAR_ICONPADDING = 4;
 const int TCRUNCHER_UNDO_TYPE_TABLE = 1;
 const int TCRUNCHER_UNDO_TYPE_CELL = 2;
 const int TCRUNCHER_UNDO_TYPE_HEADERROW = 3;
+const int TCRUNCHER_UNDO_TYPE_ORDER = 4;				// just the row order of a sorted table
+const int TCRUNCHER_UNDO_TYPE_ROWS = 5;					// rows inserted or deleted: just the deleted rows
+const int TCRUNCHER_UNDO_TYPE_COLUMNS = 6;				// columns inserted, deleted or changed: just the deleted and changed columns
+const int TCRUNCHER_UNDO_TYPE_MOVE_COLUMNS = 7;			// columns moved by one: just their new position
+const int TCRUNCHER_UNDO_TYPE_FLAGS = 8;				// just the flags
 
 const int TCRUNCHER_SMALL_WINDOW_BACKGROUND = 0xF0F0F000;
 #define TCRUNCHER_SMALL_WINDOW_BACKGROUND_HTMLCODE "#F0F0F0"
@@ -118,6 +125,7 @@ const int TCRUNCHER_MAX_FONT_SIZE = 30;
 const int TCRUNCHER_MIN_FONT_SIZE = 8;
 const int TCRUNCHER_FONT_NUMBER = 9900;
 #define TCRUNCHER_FALLBACK_FONT "Menlo"
+const int TCRUNCHER_MAX_GRID_ROWS = INT_MAX / (TCRUNCHER_MAX_FONT_SIZE + TCRUNCHER_ROW_HEIGHT_ADD + 1);	// Fl_Table sums up the row heights as int: tables with more rows are only partially shown
 
 
 /************************************************************************************
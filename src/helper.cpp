@@ -28,6 +28,7 @@
 
 
 #include "helper.hh"
+#include "utf8-cpp-utils/utf8_cpp_tables.hh"
 
 
 /**
@@ -129,6 +130,10 @@ std::string Helper::groupedIntToString( int num, std::string sep ) {
 
 // fixes UTF8 inplace – replaces invalid octets with replace character
 void Helper::fixUtf8(std::string& str) {
+	if( utf8::find_invalid(str.begin(), str.end()) == str.end() ) {
+		// nothing to fix: don't copy
+		return;
+	}
     std::string temp;
 	try {
 	    utf8::replace_invalid(str.begin(), str.end(), back_inserter(temp));
@@ -375,7 +380,7 @@ std::string Helper::utf8toutf16(std::string text, bool bigEndian) {
 /*
  * Checks if string is a number - a little bit buggy ... TODO
  */
-bool Helper::isNumber(const std::string& str) {
+bool Helper::isNumber(std::string_view str) {
     bool isNum = true;
     size_t str_len = str.size();
     for(size_t i = 0; i < str_len; ++i ) {
@@ -418,31 +423,36 @@ bool Helper::isInteger(const std::string& s) {
 
 /*
  *	Parses the given string and returns an integer or a float.
+ *	Leading whitespace and a leading '+' are skipped, the rest of the string has to be the number.
+ *	Uses std::from_chars(), so no exceptions are thrown and the locale doesn't matter.
  */
-Helper::parseNumberStruct Helper::parseNumber(const std::string& s) {
-	size_t myIndex;
-	long long myInteger;
-	long double myFloat;
+Helper::parseNumberStruct Helper::parseNumber(std::string_view s) {
 	struct parseNumberStruct ret;
-	
-	try {										// convert to long long
-		myInteger = std::stoll( s, &myIndex );
-		if( myIndex < s.size() ) {
-			throw myInteger;
-		}
+	size_t start = 0;
+	while( start < s.size() && std::isspace(static_cast<unsigned char>(s[start])) ) {
+		++start;
+	}
+	if( start + 1 < s.size() && s[start] == '+' && s[start + 1] != '-' ) {
+		++start;
+	}
+	const char *first = s.data() + start;
+	const char *last = s.data() + s.size();
+	if( first == last ) {
+		return ret;
+	}
+
+	long long myInteger;
+	std::from_chars_result result = std::from_chars(first, last, myInteger);
+	if( result.ec == std::errc() && result.ptr == last ) {
 		ret.myType = parseNumberType::INT;
 		ret.myInteger = myInteger;
-	} catch(...) {
-		try {									// convert to long double
-			myFloat = std::stold( s, &myIndex );
-			if( myIndex < s.size() ) {
-				throw myFloat;
-			}
-			ret.myType = parseNumberType::FLOAT;
-			ret.myFloat = myFloat;
-		} catch(...) {							// use cell as string
-			ret.myType = parseNumberType::NONE;
-		}
+		return ret;
+	}
+	double myFloat;
+	result = std::from_chars(first, last, myFloat);
+	if( result.ec == std::errc() && result.ptr == last ) {
+		ret.myType = parseNumberType::FLOAT;
+		ret.myFloat = myFloat;
 	}
 	return ret;
 }
@@ -677,6 +687,9 @@ std::string Helper::getHomeDir() {
 	return homeDirStr;
 }
 
+/**
+	Returns the size of the physical memory in bytes, 0 if it's unknown
+ */
 int64_t Helper::getPhysMemSize() {
 	#ifdef __APPLE__
 	int mib[2];
@@ -690,9 +703,19 @@ int64_t Helper::getPhysMemSize() {
 	sysctl(mib, 2, &physical_memory, &length, NULL, 0);
 	return physical_memory;
 	#elif _WIN64
-	return 8000000;			// TODO remove hard coded physical memory size on Windows
+	MEMORYSTATUSEX status;
+	status.dwLength = sizeof(status);
+	if( GlobalMemoryStatusEx(&status) ) {
+		return (int64_t) status.ullTotalPhys;
+	}
+	return 0;
 	#else
-	return 8000000;			// TODO remove hard coded physical memory size on Linux
+	long pages = sysconf(_SC_PHYS_PAGES);
+	long pageSize = sysconf(_SC_PAGE_SIZE);
+	if( pages > 0 && pageSize > 0 ) {
+		return (int64_t) pages * pageSize;
+	}
+	return 0;
 	#endif
 }
 
@@ -793,6 +816,120 @@ unsigned int Helper::getFltkFontCode(std::string fontname) {
 
 
 
+/**
+	Returns a key for sorting strings the way people expect, comparing two keys byte by byte gives their order:
+	case and the accents of Latin letters are ignored and runs of digits compare as numbers ("item2" < "item10").
+	The key consists of
+	  * one element per character: the casefolded character without accents (e.g. "É" -> "e", "ß" -> "ss"),
+	    bytes below 0x02 are raised to 0x02
+	  * one element per run of digits: 0x01, the number of digits (without leading zeros) and the digits
+	  * a 0 byte and the original string, which orders strings that only differ in case, accents or leading zeros
+ */
+std::string Helper::collationKey(std::string_view s) {
+	// base letters of U+00C0 ... U+017F (Latin-1 Supplement and Latin Extended-A), "" if there's none
+	static const char *latinBaseLetters[] = {
+	"a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",		// U+00C0
+	"d", "n", "o", "o", "o", "o", "o", "", "o", "u", "u", "u", "u", "y", "th", "ss",		// U+00D0
+	"a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",		// U+00E0
+	"d", "n", "o", "o", "o", "o", "o", "", "o", "u", "u", "u", "u", "y", "th", "y",		// U+00F0
+	"a", "a", "a", "a", "a", "a", "c", "c", "c", "c", "c", "c", "c", "c", "d", "d",		// U+0100
+	"d", "d", "e", "e", "e", "e", "e", "e", "e", "e", "e", "e", "g", "g", "g", "g",		// U+0110
+	"g", "g", "g", "g", "h", "h", "h", "h", "i", "i", "i", "i", "i", "i", "i", "i",		// U+0120
+	"i", "i", "ij", "ij", "j", "j", "k", "k", "k", "l", "l", "l", "l", "l", "l", "l",		// U+0130
+	"l", "l", "l", "n", "n", "n", "n", "n", "n", "n", "n", "n", "o", "o", "o", "o",		// U+0140
+	"o", "o", "oe", "oe", "r", "r", "r", "r", "r", "r", "s", "s", "s", "s", "s", "s",		// U+0150
+	"s", "s", "t", "t", "t", "t", "t", "t", "u", "u", "u", "u", "u", "u", "u", "u",		// U+0160
+	"u", "u", "u", "u", "w", "w", "y", "y", "y", "z", "z", "z", "z", "z", "z", "s",		// U+0170
+	};
+	std::string key;
+	key.reserve(s.size() + s.size() / 2 + 1);
+	size_t i = 0;
+	while( i < s.size() ) {
+		unsigned char c = static_cast<unsigned char>(s[i]);
+		if( c >= '0' && c <= '9' ) {
+			size_t start = i;
+			while( i < s.size() && s[i] >= '0' && s[i] <= '9' ) {
+				++i;
+			}
+			while( start + 1 < i && s[start] == '0' ) {
+				++start;
+			}
+			key.push_back( (char) 0x01 );
+			key.push_back( (char) std::min(i - start, (size_t) 255) );
+			key.append( s.substr(start, i - start) );
+			continue;
+		}
+		if( c < 0x80 ) {
+			key.push_back( (char) std::max( (unsigned char) (c >= 'A' && c <= 'Z' ? c + 32 : c), (unsigned char) 0x02 ) );
+			++i;
+			continue;
+		}
+		// decode a UTF-8 sequence, invalid bytes are taken as they are
+		size_t len = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+		uint32_t cp = c & (0x7F >> len);
+		for( size_t k = 1; k < len; ++k ) {
+			if( i + k >= s.size() || (static_cast<unsigned char>(s[i + k]) & 0xC0) != 0x80 ) {
+				len = 1;
+				break;
+			}
+			cp = (cp << 6) | (static_cast<unsigned char>(s[i + k]) & 0x3F);
+		}
+		if( len == 1 ) {
+			key.push_back( (char) c );
+			++i;
+			continue;
+		}
+		i += len;
+		std::vector<int32_t> folded = { (int32_t) cp };
+		auto it = Utf8CppUtils::_casefold_codepoint_table.find( (int32_t) cp );
+		if( it != Utf8CppUtils::_casefold_codepoint_table.end() ) {
+			folded = it->second;
+		}
+		for( int32_t f : folded ) {
+			if( f >= 0xC0 && f < 0x180 && *latinBaseLetters[f - 0xC0] ) {
+				key.append( latinBaseLetters[f - 0xC0] );
+			} else {
+				key.append( encodeUtf8( (uint32_t) f ) );
+			}
+		}
+	}
+	key.push_back( (char) 0x00 );
+	key.append(s);
+	return key;
+}
 
 
 
+/**
+	Returns into how many chunks parallelFor() splits `count` items: one per hardware thread,
+	but no chunk smaller than `minChunkSize`.
+ */
+size_t Helper::parallelChunks(size_t count, size_t minChunkSize) {
+	size_t threads = std::max(1u, std::thread::hardware_concurrency());
+	size_t chunks = minChunkSize ? count / minChunkSize : threads;
+	return std::max( (size_t) 1, std::min(chunks, threads) );
+}
+
+
+/**
+	Calls func(chunk, from, to) for the consecutive ranges [from, to) that cover the items 0 ... count-1,
+	each chunk in a thread of its own. Returns when all chunks are done. Chunk `i` always covers the
+	range [count * i / chunks, count * (i+1) / chunks) with `chunks` returned by parallelChunks().
+
+	`func` must not call FLTK functions, as they may only be called from the main thread.
+ */
+void Helper::parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t chunk, size_t from, size_t to)> &func) {
+	size_t chunks = parallelChunks(count, minChunkSize);
+	if( chunks == 1 ) {
+		func(0, 0, count);
+		return;
+	}
+	std::vector<std::thread> workers;
+	for( size_t i = 1; i < chunks; ++i ) {
+		workers.emplace_back(func, i, count * i / chunks, count * (i + 1) / chunks);
+	}
+	func(0, 0, count / chunks);
+	for( std::thread &worker : workers ) {
+		worker.join();
+	}
+}
@@ -27,6 +27,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <sstream>
@@ -37,6 +38,9 @@
 #include <sys/stat.h>
 #include <codecvt>
 #include <cmath>
+#include <thread>
+#include <functional>
+#include <charconv>
 
 #include "utf8.h"
 
@@ -50,6 +54,10 @@
 #include <windows.h>
 #endif
 
+#if !defined(__APPLE__) && !defined(_WIN64)
+#include <unistd.h>
+#endif
+
 
 
 class Helper {
@@ -70,12 +78,13 @@ public:
 	static std::string win1252toutf8(std::string text);
 	static std::string utf8tolatin1(std::string text, bool win1252=false);
 	static std::string utf8toutf16(std::string text, bool bigEndian=true);
-	static bool isNumber(const std::string& s);
+	static bool isNumber(std::string_view s);
 	static bool isFloat(const std::string& s, char decimal_point = '.');
 	static bool isInteger(const std::string& s);
 	static bool isEmailAddress(const std::string& email);
 	static bool isSomeDate(const std::string& dateString);
-	static struct parseNumberStruct parseNumber(const std::string& s);
+	static struct parseNumberStruct parseNumber(std::string_view s);
+	static std::string collationKey(std::string_view s);
 	static std::string getBasename(const std::string& path);
 	static std::string getDirectory(const std::string& path);
 	static std::pair<std::string,std::string> getPathWithoutExtension(const std::string& path);
@@ -97,6 +106,46 @@ public:
 	static std::string ws_to_utf8(std::wstring const& s);
 	static std::wstring utf8_to_ws(std::string const& utf8);
 	static void log(std::string msg);
+	static size_t parallelChunks(size_t count, size_t minChunkSize);
+	static void parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t chunk, size_t from, size_t to)> &func);
+
+	/**
+		Stable sort of `items` using all cores: the chunks of parallelFor() are sorted in parallel, then
+		neighbouring runs are merged pairwise, all merges of a round in parallel.
+	 */
+	template<typename T, typename Less>
+	static void parallelSort(std::vector<T> &items, size_t minChunkSize, Less less) {
+		size_t count = items.size();
+		size_t chunks = parallelChunks(count, minChunkSize);
+		std::vector<size_t> bounds;						// run i is [bounds[i], bounds[i+1])
+		for( size_t i = 0; i <= chunks; ++i ) {
+			bounds.push_back( count * i / chunks );
+		}
+		parallelFor(count, minChunkSize, [&](size_t, size_t from, size_t to) {
+			std::stable_sort(items.begin() + from, items.begin() + to, less);
+		});
+		std::vector<T> buffer(chunks > 1 ? count : 0);
+		while( bounds.size() > 2 ) {
+			size_t runs = bounds.size() - 1;
+			parallelFor(runs / 2, 1, [&](size_t, size_t from, size_t to) {
+				for( size_t pair = from; pair < to; ++pair ) {
+					std::merge(items.begin() + bounds[2 * pair], items.begin() + bounds[2 * pair + 1],
+							   items.begin() + bounds[2 * pair + 1], items.begin() + bounds[2 * pair + 2],
+							   buffer.begin() + bounds[2 * pair], less);
+				}
+			});
+			if( runs % 2 ) {								// the last run has no partner in this round
+				std::copy(items.begin() + bounds[runs - 1], items.end(), buffer.begin() + bounds[runs - 1]);
+			}
+			items.swap(buffer);
+			std::vector<size_t> merged;
+			for( size_t i = 0; i < runs; i += 2 ) {
+				merged.push_back(bounds[i]);
+			}
+			merged.push_back(count);
+			bounds.swap(merged);
+		}
+	}
 private:
 	static std::map<const unsigned int, const unsigned char> unicode2win1252;
 };
@@ -0,0 +1,137 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Stefan Fischerländer
+ *
+ * This file is part of Tablecruncher.
+ *
+ * Tablecruncher is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * Tablecruncher is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tablecruncher. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef _LINEREADER_HH
+#define _LINEREADER_HH
+
+
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <streambuf>
+
+
+
+/**
+	\brief Reads lines from a `std::streambuf` through a large buffer.
+
+	The stream is read in blocks: the first one is small so that probing a few lines stays cheap, every
+	following block doubles in size up to `MAX_BLOCK`. Line ends are found with `memchr()` instead of looking
+	at every byte. LF, CR and CRLF end a line, NUL bytes are skipped.
+
+	The reader consumes the stream ahead of the lines it has returned, so the stream position is undefined
+	once it is done.
+ */
+class LineReader {
+
+public:
+	static constexpr size_t MIN_BLOCK = 64 * 1024;
+	static constexpr size_t MAX_BLOCK = 4 * 1024 * 1024;
+
+	explicit LineReader(std::streambuf *sb) : sb(sb), buffer(new char[MAX_BLOCK]) {}
+
+	/**
+		Reads the next line into `t`, without its line ending
+
+		Returns false if the stream was exhausted before any byte of the line could be read.
+	 */
+	bool getline(std::string &t) {
+		t.clear();
+		return appendLine(t);
+	}
+
+	/**
+		Appends the next line to `t`, without its line ending – returns false like `getline()`
+	 */
+	bool appendLine(std::string &t) {
+		size_t start = t.size();
+		for(;;) {
+			if( pos == end ) {
+				if( !refill() ) {
+					return t.size() > start;
+				}
+			}
+			const char *special = nextSpecial();
+			t.append(pos, special - pos);
+			pos = special;
+			if( pos == end ) {
+				continue;
+			}
+			char c = *pos++;
+			if( c == '\n' ) {
+				return true;
+			}
+			if( c == '\r' ) {
+				if( pos < end || refill() ) {
+					if( *pos == '\n' ) {
+						++pos;
+					}
+				}
+				return true;
+			}
+			// c == '\0': skipped
+		}
+	}
+
+
+private:
+	std::streambuf *sb;
+	std::unique_ptr<char[]> buffer;
+	size_t blockSize = MIN_BLOCK;
+	const char *pos = nullptr;				// next unread byte
+	const char *end = nullptr;				// end of the bytes read into `buffer`
+	const char *nextLF = nullptr;			// last found '\n', `end` if there's none left, nullptr after a refill
+	const char *nextCR = nullptr;
+	const char *nextNUL = nullptr;
+
+	bool refill() {
+		std::streamsize got = sb->sgetn(buffer.get(), blockSize);
+		blockSize = std::min(blockSize * 2, MAX_BLOCK);
+		pos = buffer.get();
+		end = pos + (got > 0 ? got : 0);
+		nextLF = nextCR = nextNUL = nullptr;
+		return got > 0;
+	}
+
+	const char *find(const char *&next, char c) {
+		if( !next || next < pos ) {
+			next = static_cast<const char *>(std::memchr(pos, c, end - pos));
+			if( !next ) {
+				next = end;
+			}
+		}
+		return next;
+	}
+
+	/**
+		Returns the first '\n', '\r' or '\0' at or after `pos`, or `end`
+	 */
+	const char *nextSpecial() {
+		return std::min({find(nextLF, '\n'), find(nextCR, '\r'), find(nextNUL, '\0')});
+	}
+
+};
+
+
+#endif
@@ -55,7 +55,7 @@ Macro::~Macro() {
 
 void *Macro::logDisplay = NULL;
 bool Macro::tableModified = false;
-std::vector<int> Macro::lastResultInts = {};
+std::vector<table_index_t> Macro::lastResultInts = {};
 std::vector<std::string> Macro::lastResultStrings = {};
 
 	
@@ -68,7 +68,7 @@ std::vector<std::string> Macro::lastResultStrings = {};
  *	TODO call duk_peval_string() in its own thread to avoid endless loops
  *	https://stackoverflow.com/a/56268886/2771733
  */
-std::tuple<int, std::string> Macro::execute(CsvTable *table, std::tuple<int, int, int, int> selection, std::string source, void *logDisplay) {
+std::tuple<int, std::string> Macro::execute(CsvTable *table, std::tuple<table_index_t, table_index_t, table_index_t, table_index_t> selection, std::string source, void *logDisplay) {
 	int retCode = 0;
 	this->table = table;
 	Macro::logDisplay = logDisplay;
@@ -87,6 +87,19 @@ std::tuple<int, std::string> Macro::execute(CsvTable *table, std::tuple<int, int
 }
 
 
+/*
+ *	Converts the argument at `index` to a row or column index. Unlike duk_to_int() this doesn't clip at 32 bit,
+ *	so tables with more than 2^31 rows can be addressed. NaN results in 0.
+ */
+table_index_t Macro::toIndex(duk_context *context, duk_idx_t index) {
+	duk_double_t value = duk_to_number(context, index);
+	if( std::isnan(value) ) {
+		return 0;
+	}
+	return (table_index_t) std::max(std::min(value, 9.0e18), -9.0e18);
+}
+
+
 /*
  *
  */
@@ -95,8 +108,8 @@ duk_ret_t Macro::apiSetCell(duk_context *context) {
 	duk_idx_t numArgs = duk_get_top(context);
 	if( numArgs == 3 ) {
 		if( duk_get_type(context, 0) == DUK_TYPE_NUMBER && duk_get_type(context, 1) == DUK_TYPE_NUMBER) {
-			duk_uint_t row = duk_to_uint(context, 0);
-			duk_uint_t col = duk_to_uint(context, 1);
+			table_index_t row = toIndex(context, 0);
+			table_index_t col = toIndex(context, 1);
 			if( duk_get_type(context, 2) == DUK_TYPE_STRING ) {
 				str = duk_safe_to_string(context, 2);
 			} else if( duk_get_type(context, 2) == DUK_TYPE_NUMBER ) {
@@ -118,8 +131,8 @@ duk_ret_t Macro::apiGetString(duk_context *context) {
 	duk_idx_t numArgs = duk_get_top(context);
 	if( numArgs == 2 ) {
 		if( duk_get_type(context, 0) == DUK_TYPE_NUMBER && duk_get_type(context, 1) == DUK_TYPE_NUMBER ) {
-			duk_uint_t row = duk_to_uint(context, 0);
-			duk_uint_t col = duk_to_uint(context, 1);
+			table_index_t row = toIndex(context, 0);
+			table_index_t col = toIndex(context, 1);
 			std::string cell_str = macro.table->getCell(row, col);
 			duk_push_string(context, cell_str.c_str());
 			return 1;
@@ -131,8 +144,8 @@ duk_ret_t Macro::apiGetInt(duk_context *context) {
 	duk_idx_t numArgs = duk_get_top(context);
 	if( numArgs == 2 ) {
 		if( duk_get_type(context, 0) == DUK_TYPE_NUMBER && duk_get_type(context, 1) == DUK_TYPE_NUMBER ) {
-			duk_uint_t row = duk_to_uint(context, 0);
-			duk_uint_t col = duk_to_uint(context, 1);
+			table_index_t row = toIndex(context, 0);
+			table_index_t col = toIndex(context, 1);
 			std::string cell_str = macro.table->getCell(row, col);
 			try {
 				long cell_int = std::stol(cell_str);
@@ -149,8 +162,8 @@ duk_ret_t Macro::apiGetFloat(duk_context *context) {
 	duk_idx_t numArgs = duk_get_top(context);
 	if( numArgs == 2 ) {
 		if( duk_get_type(context, 0) == DUK_TYPE_NUMBER && duk_get_type(context, 1) == DUK_TYPE_NUMBER ) {
-			duk_uint_t row = duk_to_uint(context, 0);
-			duk_uint_t col = duk_to_uint(context, 1);
+			table_index_t row = toIndex(context, 0);
+			table_index_t col = toIndex(context, 1);
 			std::string cell_str = macro.table->getCell(row, col);
 			try {
 				double cell_float = std::stod(cell_str);
@@ -170,7 +183,7 @@ duk_ret_t Macro::apiGetFloat(duk_context *context) {
 duk_ret_t Macro::apiFlagRow(duk_context *context) {
 	duk_idx_t numArgs = duk_get_top(context);
 	if( numArgs == 1 ) {
-		duk_uint_t row = duk_to_uint(context, 0);
+		table_index_t row = toIndex(context, 0);
 		macro.table->flagRow(row, true);
 		return 1;
 	}
@@ -218,7 +231,7 @@ duk_ret_t Macro::internalStoreInts(duk_context *context) {
 	for( int i = 0; i < numArgs; ++i ) {
 		if( duk_get_type(context, i) == DUK_TYPE_NUMBER ) {
 			// dummyInt = duk_to_int(context, i);
-			Macro::lastResultInts.push_back(duk_to_int(context, i));
+			Macro::lastResultInts.push_back(toIndex(context, i));
 		}
 	}
 	return 0;
@@ -227,7 +240,7 @@ duk_ret_t Macro::internalStoreInts(duk_context *context) {
 /**
  *	Returns the last stored Int results
  */
-std::vector<int> Macro::getLastResultInts() {
+std::vector<table_index_t> Macro::getLastResultInts() {
 	return Macro::lastResultInts;
 }
 
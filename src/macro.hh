@@ -27,6 +27,8 @@
 #include <string>
 #include <vector>
 #include <thread>
+#include <cmath>
+#include <algorithm>
 
 #include "duktape/duktape.h"
 
@@ -40,7 +42,7 @@ class Macro {
 public:
 	Macro();
 	~Macro();
-	std::tuple<int, std::string> execute(CsvTable *table, std::tuple<int, int, int, int> selection, std::string source, void *logDisplay = NULL);
+	std::tuple<int, std::string> execute(CsvTable *table, std::tuple<table_index_t, table_index_t, table_index_t, table_index_t> selection, std::string source, void *logDisplay = NULL);
 	static duk_ret_t apiSetCell(duk_context *context);
 	static duk_ret_t apiGetString(duk_context *context);
 	static duk_ret_t apiGetInt(duk_context *context);
@@ -51,15 +53,16 @@ public:
 	static duk_ret_t internalStoreStrings(duk_context *context);	// place to store results from the macro to be used by the application internally
 	static duk_ret_t internalPrintln(duk_context *context);			// prints to stdout
 	static void fatalErrorHandler(void *, const char *);
-	static std::vector<int> getLastResultInts();
+	static std::vector<table_index_t> getLastResultInts();
 	static std::vector<std::string> getLastResultStrings();
 private:
 	duk_context *context;
 	CsvTable *table;
 	static bool tableModified;
 	static void *logDisplay;
-	static std::vector<int> lastResultInts;					
+	static std::vector<table_index_t> lastResultInts;					
 	static std::vector<std::string> lastResultStrings;
+	static table_index_t toIndex(duk_context *context, duk_idx_t index);	// converts a JS number to a row or column index
 };
 
 
@@ -77,6 +77,9 @@ int main(int argc, char** argv) {
 	int runState;
 	std::string homeDir;
 
+	// enables Fl::awake() for the threads loading files
+	Fl::lock();
+
 	#ifdef __APPLE__
 	fl_mac_set_about(&CsvApplication::aboutCB, NULL);
 	#endif
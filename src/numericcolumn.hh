@@ -0,0 +1,142 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Stefan Fischerländer
+ *
+ * This file is part of Tablecruncher.
+ *
+ * Tablecruncher is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * Tablecruncher is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tablecruncher. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _NUMERICCOLUMN_HH
+#define _NUMERICCOLUMN_HH
+
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <functional>
+
+#include "helper.hh"
+#include "rowbitmap.hh"
+
+
+
+/**
+	\brief The cells of a single column parsed as numbers, one entry per row.
+
+	Every cell is parsed once by `Helper::parseNumber()`: `isNumber()` tells whether it's a number at all,
+	`isInteger()` whether it's an integer (which is kept as `int64_t`, so large values stay exact). Cells that
+	aren't numbers read as 0.
+
+	Built by `CsvDataStorage::numbers()`, which keeps it until the column or the order of the rows changes.
+ */
+class NumericColumn {
+
+public:
+	/**
+		Parses `rows` cells, `cell(R)` returning the content of row R. The rows are split into ranges of
+		whole bitmap words, which are parsed in parallel.
+	 */
+	NumericColumn(size_t rows, size_t minChunkSize, const std::function<std::string_view(size_t)> &cell) : values(rows) {
+		size_t numWords = (rows + 63) / 64;
+		std::vector<uint64_t> validWords(numWords, 0);
+		std::vector<uint64_t> integerWords(numWords, 0);
+		Helper::parallelFor(numWords, (minChunkSize + 63) / 64, [&](size_t, size_t from, size_t to) {
+			for( size_t R = from * 64; R < to * 64 && R < rows; ++R ) {
+				uint64_t bit = (uint64_t) 1 << (R % 64);
+				Helper::parseNumberStruct parsed = Helper::parseNumber( cell(R) );
+				if( parsed.myType == Helper::parseNumberType::INT ) {
+					values[R].integer = parsed.myInteger;
+					validWords[R / 64] |= bit;
+					integerWords[R / 64] |= bit;
+				} else if( parsed.myType == Helper::parseNumberType::FLOAT ) {
+					values[R].real = (double) parsed.myFloat;
+					validWords[R / 64] |= bit;
+				} else {
+					values[R].integer = 0;
+				}
+			}
+		});
+		valid = RowBitmap( std::move(validWords) );
+		integers = RowBitmap( std::move(integerWords) );
+	}
+
+	size_t size() const {
+		return values.size();
+	}
+
+	/**
+		Number of cells that are numbers
+	 */
+	size_t count() const {
+		return valid.count();
+	}
+
+	/**
+		True if every number is an integer (cells that aren't numbers count as integer 0)
+	 */
+	bool allIntegers() const {
+		return integers.count() == valid.count();
+	}
+
+	bool isNumber(size_t R) const {
+		return valid.test(R);
+	}
+
+	bool isInteger(size_t R) const {
+		return integers.test(R);
+	}
+
+	int64_t integerAt(size_t R) const {
+		return integers.test(R) ? values[R].integer : (int64_t) realAt(R);
+	}
+
+	double realAt(size_t R) const {
+		if( integers.test(R) ) {
+			return (double) values[R].integer;
+		}
+		return valid.test(R) ? values[R].real : 0;
+	}
+
+	/**
+		Parses `content` as the new content of row R
+	 */
+	void update(size_t R, std::string_view content) {
+		Helper::parseNumberStruct parsed = Helper::parseNumber(content);
+		valid.set(R, parsed.myType != Helper::parseNumberType::NONE);
+		integers.set(R, parsed.myType == Helper::parseNumberType::INT);
+		if( parsed.myType == Helper::parseNumberType::INT ) {
+			values[R].integer = parsed.myInteger;
+		} else {
+			values[R].real = (double) parsed.myFloat;
+		}
+	}
+
+
+private:
+	union Value {
+		int64_t integer;
+		double real;
+	};
+	std::vector<Value> values;						// integer or real, depending on `integers`
+	RowBitmap valid;								// rows that are numbers
+	RowBitmap integers;								// rows that are integers
+
+};
+
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Stefan Fischerländer
+ *
+ * This file is part of Tablecruncher.
+ *
+ * Tablecruncher is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * Tablecruncher is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tablecruncher. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef _RADIXSORT_HH
+#define _RADIXSORT_HH
+
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+
+
+/**
+	\brief Radix sorts for items carrying an unsigned 64-bit key.
+
+	`lsd()` sorts by the whole key, stable and with one pass per byte. Bytes that are the same for all keys (e.g.
+	the high bytes of timestamps) are skipped. Numbers are turned into keys with `orderedKey()`, which keeps their
+	order: comparing the keys gives the same result as comparing the numbers.
+
+	`msd()` sorts in place (American flag sort) by a key that is only a prefix, e.g. the first 8 bytes of a
+	string: the items are distributed by the highest byte, then every bucket by the next byte and so on.
+	Buckets that are small or whose prefixes are equal are finished by `std::sort()` with the full comparison.
+ */
+class RadixSort {
+
+public:
+	/**
+		Returns a key with the same order as the doubles: the sign bit is flipped for positive values, all bits
+		for negative ones. -0 and NaN give the key of 0.
+	 */
+	static uint64_t orderedKey(double value) {
+		if( value == 0 || std::isnan(value) ) {
+			value = 0;
+		}
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return (bits & SIGN_BIT) ? ~bits : bits | SIGN_BIT;
+	}
+
+	/**
+		Returns a key with the same order as the integers
+	 */
+	static uint64_t orderedKey(int64_t value) {
+		return (uint64_t) value ^ SIGN_BIT;
+	}
+
+	/**
+		Stable LSD radix sort of `items` by `key(item)` in ascending order
+	 */
+	template<typename T, typename Key>
+	static void lsd(std::vector<T> &items, Key key) {
+		size_t n = items.size();
+		std::vector<size_t> counts(8 * 256, 0);			// the histograms of all 8 bytes, counted in a single pass
+		for( const T &item : items ) {
+			uint64_t k = key(item);
+			for( int byte = 0; byte < 8; ++byte ) {
+				++counts[byte * 256 + ((k >> (byte * 8)) & 0xFF)];
+			}
+		}
+		std::vector<T> buffer(n);
+		for( int byte = 0; byte < 8; ++byte ) {
+			size_t *count = &counts[byte * 256];
+			if( std::find(count, count + 256, n) != count + 256 ) {
+				continue;									// all keys have the same byte here
+			}
+			size_t offset = 0;
+			for( int digit = 0; digit < 256; ++digit ) {
+				size_t c = count[digit];
+				count[digit] = offset;
+				offset += c;
+			}
+			for( const T &item : items ) {
+				buffer[count[(key(item) >> (byte * 8)) & 0xFF]++] = item;
+			}
+			items.swap(buffer);
+		}
+	}
+
+	/**
+		In-place MSD radix sort of `items` by `prefix(item)` in ascending order. `less` has to be a strict
+		weak ordering that agrees with the prefixes – it's used for items with equal prefixes and small buckets.
+		The result is the same as `std::sort(items.begin(), items.end(), less)` if `less` is a total order.
+	 */
+	template<typename T, typename Prefix, typename Less>
+	static void msd(std::vector<T> &items, Prefix prefix, Less less) {
+		msdRange(items.data(), items.data() + items.size(), 7, prefix, less);
+	}
+
+
+private:
+	static constexpr uint64_t SIGN_BIT = (uint64_t) 1 << 63;
+	static constexpr size_t MSD_MIN_ITEMS = 64;			// smaller buckets are left to std::sort()
+
+	template<typename T, typename Prefix, typename Less>
+	static void msdRange(T *first, T *last, int byte, Prefix &prefix, Less &less) {
+		size_t n = last - first;
+		if( n < MSD_MIN_ITEMS || byte < 0 ) {
+			std::sort(first, last, less);
+			return;
+		}
+		auto digitOf = [&](const T &item) {
+			return (size_t) ((prefix(item) >> (byte * 8)) & 0xFF);
+		};
+		size_t counts[256] = {0};
+		for( T *item = first; item != last; ++item ) {
+			++counts[digitOf(*item)];
+		}
+		size_t heads[256];
+		size_t tails[256];
+		size_t offset = 0;
+		for( size_t digit = 0; digit < 256; ++digit ) {
+			heads[digit] = offset;
+			offset += counts[digit];
+			tails[digit] = offset;
+		}
+		// swap every item into its bucket, the buckets fill up from their heads
+		for( size_t digit = 0; digit < 256; ++digit ) {
+			while( heads[digit] < tails[digit] ) {
+				T &item = first[heads[digit]];
+				size_t target = digitOf(item);
+				if( target == digit ) {
+					++heads[digit];
+				} else {
+					std::swap(item, first[heads[target]++]);
+				}
+			}
+		}
+		size_t start = 0;
+		for( size_t digit = 0; digit < 256; ++digit ) {
+			if( counts[digit] > 1 ) {
+				msdRange(first + start, first + start + counts[digit], byte - 1, prefix, less);
+			}
+			start += counts[digit];
+		}
+	}
+
+};
+
+
+#endif
@@ -0,0 +1,223 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Stefan Fischerländer
+ *
+ * This file is part of Tablecruncher.
+ *
+ * Tablecruncher is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * Tablecruncher is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tablecruncher. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _ROWBITMAP_HH
+#define _ROWBITMAP_HH
+
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <bitset>
+#include <algorithm>
+
+
+
+/**
+	\brief A set of row numbers stored as a bitmap, one bit per row.
+
+	Testing and setting a row is O(1). Counting, `rank()` (number of set rows below a row) and `select()` (the
+	k-th set row) use popcounts over 64 rows at a time. Rows can be inserted and erased, which shifts all
+	following rows, just like the table rows do.
+
+	Rows beyond the last set row don't occupy any memory, so an empty bitmap is just an empty vector.
+ */
+class RowBitmap {
+
+public:
+	static constexpr size_t npos = (size_t) -1;
+
+	RowBitmap() = default;
+
+	/**
+		Creates the bitmap from its words: bit `i % 64` of `bits[i / 64]` is row i
+	 */
+	explicit RowBitmap(std::vector<uint64_t> bits) : words(std::move(bits)) {
+		while( !words.empty() && words.back() == 0 ) {
+			words.pop_back();
+		}
+		recount();
+	}
+
+	bool test(size_t pos) const {
+		return pos / 64 < words.size() && (words[pos / 64] >> (pos % 64)) & 1;
+	}
+
+	void set(size_t pos, bool value = true) {
+		if( pos / 64 >= words.size() ) {
+			if( !value ) {
+				return;
+			}
+			words.resize(pos / 64 + 1, 0);
+		}
+		uint64_t mask = (uint64_t) 1 << (pos % 64);
+		if( value && !(words[pos / 64] & mask) ) {
+			words[pos / 64] |= mask;
+			++numSet;
+		} else if( !value && (words[pos / 64] & mask) ) {
+			words[pos / 64] &= ~mask;
+			--numSet;
+		}
+	}
+
+	size_t count() const {
+		return numSet;
+	}
+
+	bool empty() const {
+		return numSet == 0;
+	}
+
+	void clear() {
+		words.clear();
+		words.shrink_to_fit();
+		numSet = 0;
+	}
+
+	/**
+		Returns the number of set rows lower than `pos`
+	 */
+	size_t rank(size_t pos) const {
+		size_t sum = 0;
+		size_t fullWords = std::min(pos / 64, words.size());
+		for( size_t w = 0; w < fullWords; ++w ) {
+			sum += popcount(words[w]);
+		}
+		if( fullWords < words.size() && pos % 64 ) {
+			sum += popcount(words[fullWords] & (((uint64_t) 1 << (pos % 64)) - 1));
+		}
+		return sum;
+	}
+
+	/**
+		Returns the `k`-th (starting with 0) set row, or `npos` if less rows are set
+	 */
+	size_t select(size_t k) const {
+		for( size_t w = 0; w < words.size(); ++w ) {
+			size_t bits = popcount(words[w]);
+			if( k < bits ) {
+				uint64_t word = words[w];
+				for( ; k > 0; --k ) {
+					word &= word - 1;				// clear the lowest set bit
+				}
+				return w * 64 + lowestBit(word);
+			}
+			k -= bits;
+		}
+		return npos;
+	}
+
+	/**
+		Inserts `n` unset rows before `pos`, set rows from `pos` on move up by `n`
+	 */
+	void insert(size_t pos, size_t n) {
+		if( n > 0 && pos < words.size() * 64 ) {
+			words = moved(pos, pos, pos + n);
+		}
+	}
+
+	/**
+		Erases the rows [from, to), set rows from `to` on move down
+	 */
+	void erase(size_t from, size_t to) {
+		if( to > from && from < words.size() * 64 ) {
+			words = moved(from, to, from);
+			recount();
+		}
+	}
+
+	/**
+		Flips the rows [0, n), rows from `n` on get unset
+	 */
+	void invert(size_t n) {
+		words.resize((n + 63) / 64, 0);
+		for( uint64_t &word : words ) {
+			word = ~word;
+		}
+		if( n % 64 ) {
+			words.back() &= ((uint64_t) 1 << (n % 64)) - 1;
+		}
+		recount();
+	}
+
+
+private:
+	std::vector<uint64_t> words;				// bit `i % 64` of `words[i / 64]` is row i
+	size_t numSet = 0;							// number of set rows
+
+	static size_t popcount(uint64_t word) {
+		return std::bitset<64>(word).count();
+	}
+
+	static size_t lowestBit(uint64_t word) {
+		return popcount((word & (~word + 1)) - 1);
+	}
+
+	/**
+		Returns the 64 bits starting at bit `pos`, bits beyond the vector are unset
+	 */
+	uint64_t bitsAt(size_t pos) const {
+		size_t w = pos / 64;
+		size_t shift = pos % 64;
+		uint64_t low = w < words.size() ? words[w] >> shift : 0;
+		uint64_t high = (shift && w + 1 < words.size()) ? words[w + 1] << (64 - shift) : 0;
+		return low | high;
+	}
+
+	/**
+		Returns a copy of the bitmap that keeps the rows [0, keep) and moves the rows from `from` on to `to`
+	 */
+	std::vector<uint64_t> moved(size_t keep, size_t from, size_t to) const {
+		size_t oldBits = words.size() * 64;
+		size_t newBits = to + (from < oldBits ? oldBits - from : 0);
+		std::vector<uint64_t> result((newBits + 63) / 64, 0);
+		for( size_t w = 0; w < keep / 64; ++w ) {
+			result[w] = words[w];
+		}
+		if( keep % 64 ) {
+			result[keep / 64] = words[keep / 64] & (((uint64_t) 1 << (keep % 64)) - 1);
+		}
+		for( size_t k = 0; from + k < oldBits; k += 64 ) {
+			uint64_t chunk = bitsAt(from + k);
+			size_t dest = to + k;
+			result[dest / 64] |= chunk << (dest % 64);
+			if( dest % 64 && dest / 64 + 1 < result.size() ) {
+				result[dest / 64 + 1] |= chunk >> (64 - dest % 64);
+			}
+		}
+		while( !result.empty() && result.back() == 0 ) {
+			result.pop_back();
+		}
+		return result;
+	}
+
+	void recount() {
+		numSet = 0;
+		for( uint64_t word : words ) {
+			numSet += popcount(word);
+		}
+	}
+
+};
+
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Stefan Fischerländer
+ *
+ * This file is part of Tablecruncher.
+ *
+ * Tablecruncher is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * Tablecruncher is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Tablecruncher. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef _STRUCTURALINDEX_HH
+#define _STRUCTURALINDEX_HH
+
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <bitset>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define STRUCTURALINDEX_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(STRUCTURALINDEX_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define STRUCTURALINDEX_AVX2
+#include <immintrin.h>
+#endif
+
+
+
+/**
+	\brief Bitmaps of the bytes in a CSV line that can change the parser's state.
+
+	`scan()` compares the line with the delimiter, quote and escape character 64 bytes at a time, using AVX2 when
+	the CPU supports it, SSE2 otherwise and plain C++ on other architectures. Bit `i % 64` of word `i / 64` is
+	set for every structural byte i.
+
+	`next()` finds the next structural byte with a single bit scan, so the parser can copy everything in
+	between as field content. Inside quotes delimiters are field content too, they are skipped by leaving out
+	the delimiter bitmap.
+ */
+class StructuralIndex {
+
+public:
+	/**
+		Indexes the `len` bytes at `data`
+	 */
+	void scan(const char *data, size_t len, char delimiter, char quote, char escape) {
+		length = len;
+		size_t words = (len + 63) / 64;
+		delimiterBits.resize(words);
+		quoteBits.resize(words);
+		size_t fullWords = len / 64;
+		scanBlocks(data, fullWords, delimiter, quote, escape, delimiterBits.data(), quoteBits.data());
+		if( fullWords < words ) {
+			// the last partial block is scanned from a copy, bits beyond the end get cleared
+			char tail[64] = {0};
+			std::memcpy(tail, data + fullWords * 64, len % 64);
+			scanBlocks(tail, 1, delimiter, quote, escape, &delimiterBits[fullWords], &quoteBits[fullWords]);
+			uint64_t valid = ((uint64_t) 1 << (len % 64)) - 1;
+			delimiterBits[fullWords] &= valid;
+			quoteBits[fullWords] &= valid;
+		}
+	}
+
+	/**
+		Returns the first structural byte at or after `pos`, or the length of the line if there's none
+
+		If `enclosed` is true, delimiters aren't structural.
+	 */
+	size_t next(size_t pos, bool enclosed) const {
+		size_t w = pos / 64;
+		if( w >= quoteBits.size() ) {
+			return length;
+		}
+		uint64_t bits = (quoteBits[w] | (enclosed ? 0 : delimiterBits[w])) & (~(uint64_t) 0 << (pos % 64));
+		while( !bits ) {
+			if( ++w == quoteBits.size() ) {
+				return length;
+			}
+			bits = quoteBits[w] | (enclosed ? 0 : delimiterBits[w]);
+		}
+		return w * 64 + lowestBit(bits);
+	}
+
+
+private:
+	size_t length = 0;
+	std::vector<uint64_t> delimiterBits;		// delimiters
+	std::vector<uint64_t> quoteBits;			// quote and escape characters
+
+	static size_t lowestBit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctzll(word);
+#else
+		return std::bitset<64>((word & (~word + 1)) - 1).count();
+#endif
+	}
+
+	/**
+		Scans `blocks` blocks of 64 bytes and writes one word per block to `delim` and `quote`
+	 */
+	static void scanBlocks(const char *data, size_t blocks, char delimiter, char quote, char escape, uint64_t *delim, uint64_t *quot) {
+#ifdef STRUCTURALINDEX_AVX2
+		static const bool avx2 = __builtin_cpu_supports("avx2");
+		if( avx2 ) {
+			scanBlocksAvx2(data, blocks, delimiter, quote, escape, delim, quot);
+			return;
+		}
+#endif
+#ifdef STRUCTURALINDEX_SSE2
+		scanBlocksSse2(data, blocks, delimiter, quote, escape, delim, quot);
+#else
+		for( size_t b = 0; b < blocks; ++b ) {
+			uint64_t d = 0, q = 0;
+			for( int i = 0; i < 64; ++i ) {
+				char c = data[b * 64 + i];
+				d |= (uint64_t) (c == delimiter) << i;
+				q |= (uint64_t) (c == quote || c == escape) << i;
+			}
+			delim[b] = d;
+			quot[b] = q;
+		}
+#endif
+	}
+
+#ifdef STRUCTURALINDEX_SSE2
+	static void scanBlocksSse2(const char *data, size_t blocks, char delimiter, char quote, char escape, uint64_t *delim, uint64_t *quot) {
+		const __m128i d = _mm_set1_epi8(delimiter);
+		const __m128i q = _mm_set1_epi8(quote);
+		const __m128i e = _mm_set1_epi8(escape);
+		for( size_t b = 0; b < blocks; ++b ) {
+			uint64_t dBits = 0, qBits = 0;
+			for( int k = 0; k < 4; ++k ) {
+				__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + b * 64 + k * 16));
+				uint64_t dMask = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, d));
+				uint64_t qMask = (uint32_t) _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, q), _mm_cmpeq_epi8(chunk, e)));
+				dBits |= dMask << (k * 16);
+				qBits |= qMask << (k * 16);
+			}
+			delim[b] = dBits;
+			quot[b] = qBits;
+		}
+	}
+#endif
+
+#ifdef STRUCTURALINDEX_AVX2
+	__attribute__((target("avx2")))
+	static void scanBlocksAvx2(const char *data, size_t blocks, char delimiter, char quote, char escape, uint64_t *delim, uint64_t *quot) {
+		const __m256i d = _mm256_set1_epi8(delimiter);
+		const __m256i q = _mm256_set1_epi8(quote);
+		const __m256i e = _mm256_set1_epi8(escape);
+		for( size_t b = 0; b < blocks; ++b ) {
+			__m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + b * 64));
+			__m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + b * 64 + 32));
+			uint64_t dLo = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, d));
+			uint64_t dHi = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, d));
+			uint64_t qLo = (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(lo, q), _mm256_cmpeq_epi8(lo, e)));
+			uint64_t qHi = (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(hi, q), _mm256_cmpeq_epi8(hi, e)));
+			delim[b] = dLo | (dHi << 32);
+			quot[b] = qLo | (qHi << 32);
+		}
+	}
+#endif
+
+};
+
+
+#endif